@@ -0,0 +1,528 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofBench
+//
+/**\file hscptofBench.cc
+
+ Description: Microbenchmarks of the per-event kernels of the HSCPTOF modules
+
+ Implementation:
+     The kernels are the framework-free classes of the package, run on
+     synthetic events whose size is given by the benchmark arguments
+     (number of muons, segments, TrackingParticles, L1 candidates):
+       MuonHitCounter        countDTsegs/countCSCsegs/countRPChits of MuonNtupleFiller,
+                             checkMuonHits of GlobalMuonValidator
+       MuonCandidateMatcher  truth and L1 matching of MuonNtupleFiller and the timing analyzers
+       CosmicPairTagger      back-to-back pair search (spread-out muons, and cosmic showers
+                             and barrel cosmics in BM_CosmicShower)
+       TimingCutScan         hi_id_*cut_* scans of the timing analyzers
+       DimuonPairBuilder, TimingFitter
+     The *Linear and *Loop benchmarks are the old per-muon loops over the
+     whole collection / over all the cuts, for comparison.
+     The harness follows Google Benchmark: every benchmark is run with a
+     growing number of iterations until it lasts at least min_time, only the
+     timed loop is measured, and the time per iteration and the number of
+     items (muons, fills) per second are reported.
+     The events are generated with fixed seeds, so runs are comparable.
+
+ Usage:
+     hscptofBench [--filter=substring] [--min_time=seconds]
+
+     Outside CMSSW it builds with the library sources only:
+     g++ -O2 -std=c++11 -I<dir containing UserCode/HSCPTOF> bin/hscptofBench.cc
+         src/MuonHitCounter.cc src/MuonCandidateMatcher.cc src/CosmicPairTagger.cc
+         src/TimingCutScan.cc src/DimuonPairBuilder.cc src/TimingFitter.cc -o hscptofBench
+*/
+
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
+#include "UserCode/HSCPTOF/interface/MuonCandidateMatcher.h"
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+#include "UserCode/HSCPTOF/interface/TimingCutScan.h"
+#include "UserCode/HSCPTOF/interface/DimuonPairBuilder.h"
+#include "UserCode/HSCPTOF/interface/TimingFitter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  // ---------------------------------------------------------------------------------------------
+  // ----------------------- harness -------------------------------------------------------------
+  // ---------------------------------------------------------------------------------------------
+
+  class BenchState {
+  public:
+    BenchState(const vector<int>& args, unsigned long long iterations)
+      : theArgs(args), theIterations(iterations), theDone(0), theItems(0), theSeconds(0) {}
+
+    int range(unsigned int i) const { return theArgs[i]; }
+
+    // the timer runs from the first to the last call, i.e. over the loop only
+    bool keepRunning() {
+      if (theDone == 0) theStart = chrono::steady_clock::now();
+      if (theDone < theIterations) {
+        theDone++;
+        return true;
+      }
+      theSeconds = chrono::duration<double>(chrono::steady_clock::now() - theStart).count();
+      return false;
+    }
+
+    void setItemsProcessed(unsigned long long items) { theItems = items; }
+
+    unsigned long long iterations() const { return theIterations; }
+    unsigned long long items() const { return theItems; }
+    double seconds() const { return theSeconds; }
+
+  private:
+    vector<int> theArgs;
+    unsigned long long theIterations, theDone, theItems;
+    chrono::steady_clock::time_point theStart;
+    double theSeconds;
+  };
+
+  typedef void (*BenchFunction)(BenchState&);
+
+  struct Bench {
+    string name;
+    BenchFunction function;
+    vector<vector<int> > args;
+  };
+
+  // keep a result alive without an observable side effect
+  template <class T> void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  string benchName(const Bench& bench, const vector<int>& args) {
+    string name = bench.name;
+    for (int a : args) name += "/" + to_string(a);
+    return name;
+  }
+
+  void runBench(const Bench& bench, const vector<int>& args, double minTime) {
+    unsigned long long iterations = 1;
+    while (true) {
+      BenchState state(args, iterations);
+      bench.function(state);
+      if (state.seconds() >= minTime || iterations >= 1000000000ULL) {
+        double ns = 1e9 * state.seconds() / iterations;
+        double rate = state.seconds() > 0 ? state.items() / state.seconds() : 0;
+        printf("%-36s %12llu %14.1f ns", benchName(bench, args).c_str(), iterations, ns);
+        if (state.items()) printf(" %12.3g items/s", rate);
+        printf("\n");
+        return;
+      }
+      // aim at 1.4 x minTime, at most 10 times more iterations per step
+      double factor = state.seconds() > 0 ? 1.4 * minTime / state.seconds() : 10.;
+      if (factor > 10.) factor = 10.;
+      if (factor < 2.) factor = 2.;
+      iterations = (unsigned long long)(iterations * factor);
+    }
+  }
+
+  // ---------------------------------------------------------------------------------------------
+  // ----------------------- synthetic events ----------------------------------------------------
+  // ---------------------------------------------------------------------------------------------
+
+  // chambers of the toy detector; the raw ids only need to be distinct and sortable
+  const unsigned int nDTChambers = 250;
+  const unsigned int nCSCChambers = 540;
+  const unsigned int nRPCRolls = 2000;
+  const unsigned int layersPerChamber = 12;
+
+  struct SyntheticMuon {
+    float pt, eta, phi;
+    double px, py, pz;
+    vector<MuonHitCounter::ChamberMatch> matches;
+    vector<MuonHitCounter::TrackHit> rpcHits, hits;
+  };
+
+  struct SyntheticEvent {
+    vector<SyntheticMuon> muons;
+    MuonHitCounter counter;
+    // the segments in collection order, for the linear scans
+    vector<unsigned int> dtChamber;
+    vector<float> dtX, dtY;
+    MuonCandidateMatcher truth, l1;
+    vector<MuonCandidateMatcher::Direction> looseMuons;
+  };
+
+  float uniform(mt19937& rng, float low, float high) {
+    return uniform_real_distribution<float>(low, high)(rng);
+  }
+
+  unsigned int pick(mt19937& rng, unsigned int n) {
+    return uniform_int_distribution<unsigned int>(0, n - 1)(rng);
+  }
+
+  /// nSegments DT and CSC segments each, four stations per muon, nCandidates truth and L1 candidates
+  void generate(SyntheticEvent& event, unsigned int nMuons, unsigned int nSegments, unsigned int nCandidates) {
+    mt19937 rng(12345);
+    event.muons.clear();
+    event.counter.clear();
+    event.dtChamber.clear();
+    event.dtX.clear();
+    event.dtY.clear();
+    event.truth.clear();
+    event.l1.clear();
+    event.looseMuons.clear();
+
+    for (unsigned int i = 0; i < nMuons; i++) {
+      SyntheticMuon mu;
+      mu.pt = uniform(rng, 5., 500.);
+      mu.eta = uniform(rng, -2.4, 2.4);
+      mu.phi = uniform(rng, -M_PI, M_PI);
+      mu.px = mu.pt * cos(mu.phi);
+      mu.py = mu.pt * sin(mu.phi);
+      mu.pz = mu.pt * sinh(mu.eta);
+      bool barrel = fabs(mu.eta) < 1.2;
+      for (int station = 1; station <= 4; station++) {
+        MuonHitCounter::ChamberMatch ch;
+        ch.detector = barrel ? MuonHitCounter::DT : MuonHitCounter::CSC;
+        ch.chamber = barrel ? pick(rng, nDTChambers) : nDTChambers + pick(rng, nCSCChambers);
+        ch.station = station;
+        ch.x = uniform(rng, -100., 100.);
+        ch.y = uniform(rng, -100., 100.);
+        ch.hasBestSegment = true;
+        mu.matches.push_back(ch);
+        for (int layer = 0; layer < 6; layer++) {
+          MuonHitCounter::TrackHit hit = {ch.chamber * layersPerChamber + layer, ch.detector, station, 1,
+                                          ch.x + uniform(rng, -1., 1.), ch.y + uniform(rng, -1., 1.)};
+          mu.hits.push_back(hit);
+        }
+        MuonHitCounter::TrackHit rpc = {pick(rng, nRPCRolls), MuonHitCounter::RPC, station, 1 + (int)pick(rng, 2),
+                                        ch.x, 0.};
+        mu.rpcHits.push_back(rpc);
+      }
+      event.muons.push_back(mu);
+      if (mu.pt > 30) {
+        MuonCandidateMatcher::Direction dir = {i, mu.eta, mu.phi};
+        event.looseMuons.push_back(dir);
+      }
+    }
+
+    // segments: half of them in the chambers crossed by the muons, the rest anywhere
+    for (unsigned int i = 0; i < nSegments; i++) {
+      bool onMuon = nMuons && i % 2 == 0;
+      const MuonHitCounter::ChamberMatch* ch = 0;
+      if (onMuon) {
+        const SyntheticMuon& mu = event.muons[pick(rng, nMuons)];
+        ch = &mu.matches[pick(rng, mu.matches.size())];
+      }
+      unsigned int dt = ch && ch->detector == MuonHitCounter::DT ? ch->chamber : pick(rng, nDTChambers);
+      float x = (ch ? ch->x : 0) + uniform(rng, -30., 30.), y = (ch ? ch->y : 0) + uniform(rng, -30., 30.);
+      event.counter.addDTSegment(dt, x, y);
+      event.dtChamber.push_back(dt);
+      event.dtX.push_back(x);
+      event.dtY.push_back(y);
+      unsigned int csc = ch && ch->detector == MuonHitCounter::CSC ? ch->chamber : nDTChambers + pick(rng, nCSCChambers);
+      event.counter.addCSCSegment(csc, x, y, 3 + pick(rng, 4));
+      event.counter.addRPCHit(pick(rng, nRPCRolls), x, (int)pick(rng, 3) - 1);
+      // a few rechits per segment, spread over the layers of the chamber
+      for (int k = 0; k < 6; k++) {
+        event.counter.addDTRecHit(dt * layersPerChamber + pick(rng, 6), x + uniform(rng, -25., 25.));
+        event.counter.addCSCRecHit(csc * layersPerChamber + pick(rng, 6), x + uniform(rng, -25., 25.), y + uniform(rng, -25., 25.));
+      }
+    }
+    event.counter.build();
+
+    // candidates: one close to each muon as long as there are, the rest random
+    for (unsigned int i = 0; i < nCandidates; i++) {
+      float eta = uniform(rng, -2.4, 2.4), phi = uniform(rng, -M_PI, M_PI);
+      if (i < nMuons) {
+        eta = event.muons[i].eta + uniform(rng, -0.02, 0.02);
+        phi = event.muons[i].phi + uniform(rng, -0.02, 0.02);
+      }
+      event.truth.add(i, eta, phi);
+      event.l1.add(i, eta, phi);
+    }
+  }
+
+  // ---------------------------------------------------------------------------------------------
+  // ----------------------- benchmarks ----------------------------------------------------------
+  // ---------------------------------------------------------------------------------------------
+
+  // args: muons, segments
+  void BM_DTSegments(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), state.range(1), 0);
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int stations[4] = {0, 0, 0, 0};
+        event.counter.countDTSegments(mu.matches, stations);
+        doNotOptimize(stations);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  void BM_CSCSegments(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), state.range(1), 0);
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int stations[4] = {0, 0, 0, 0};
+        event.counter.countCSCSegments(mu.matches, stations);
+        doNotOptimize(stations);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // old countDTsegs: every chamber of every muon loops over the whole segment collection
+  void BM_DTSegmentsLinear(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), state.range(1), 0);
+    vector<float> xs, ys;
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int stations[4] = {0, 0, 0, 0};
+        for (const MuonHitCounter::ChamberMatch& ch : mu.matches) {
+          if (ch.detector != MuonHitCounter::DT) continue;
+          xs.clear();
+          ys.clear();
+          for (unsigned int s = 0; s < event.dtChamber.size(); s++) {
+            if (event.dtChamber[s] != ch.chamber) continue;
+            if (fabs(event.dtX[s] - ch.x) < 25.) {
+              bool found = false;
+              for (float x : xs) if (fabs(x - event.dtX[s]) < 0.1) found = true;
+              if (!found) xs.push_back(event.dtX[s]);
+            }
+            if (fabs(event.dtY[s] - ch.y) < 25.) {
+              bool found = false;
+              for (float y : ys) if (fabs(y - event.dtY[s]) < 0.1) found = true;
+              if (!found) ys.push_back(event.dtY[s]);
+            }
+          }
+          int nsegs = (int)max(xs.size(), ys.size()) - 1;
+          if (nsegs > 0) stations[ch.station - 1] += nsegs;
+        }
+        doNotOptimize(stations);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // args: muons, segments (RPC hits and 6 x segments rechits)
+  void BM_RPCHits(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), state.range(1), 0);
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int stations[4];
+        event.counter.countRPCHits(mu.rpcHits, stations);
+        doNotOptimize(stations);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  void BM_RecHits(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), state.range(1), 0);
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int stations[4];
+        event.counter.countRecHits(mu.hits, stations);
+        doNotOptimize(stations);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // per-event cost of copying and sorting the collections; args: segments
+  void BM_HitCounterBuild(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, 0, state.range(0), 0);
+    MuonHitCounter counter;
+    while (state.keepRunning()) {
+      counter.clear();
+      for (unsigned int s = 0; s < event.dtChamber.size(); s++) {
+        counter.addDTSegment(event.dtChamber[s], event.dtX[s], event.dtY[s]);
+        counter.addCSCSegment(event.dtChamber[s], event.dtX[s], event.dtY[s], 4);
+      }
+      counter.build();
+      doNotOptimize(counter);
+    }
+    state.setItemsProcessed(state.iterations() * 2 * event.dtChamber.size());
+  }
+
+  // args: muons, TrackingParticles
+  void BM_TruthMatch(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), 0, state.range(1));
+    while (state.keepRunning())
+      for (const SyntheticMuon& mu : event.muons) {
+        int i = event.truth.matchTruth(true, mu.eta, mu.phi, true, mu.eta + 0.01, mu.phi - 0.01);
+        doNotOptimize(i);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // args: muons, L1 candidates
+  void BM_L1Match(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), 0, state.range(1));
+    vector<unsigned int> matches;
+    while (state.keepRunning())
+      for (unsigned int i = 0; i < event.muons.size(); i++) {
+        event.l1.matchL1(i, event.muons[i].eta, event.muons[i].phi, event.looseMuons, matches);
+        doNotOptimize(matches);
+      }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // args: muons
+  void BM_CosmicPairs(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), 0, 0);
+    CosmicPairTagger tagger(0.1);
+    while (state.keepRunning()) {
+      tagger.clear();
+      for (unsigned int i = 0; i < event.muons.size(); i++)
+        tagger.add(i, event.muons[i].px, event.muons[i].py, event.muons[i].pz);
+      doNotOptimize(tagger.tag());
+    }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // args: muons, 0 = shower (nearly parallel, down-going), 1 = barrel (pz~0, down-going, any angle in
+  // the x-y plane); the directions that a one-coordinate window cannot separate
+  void BM_CosmicShower(BenchState& state) {
+    mt19937 rng(2468);
+    vector<float> px, py, pz;
+    for (int i = 0; i < state.range(0); i++) {
+      if (state.range(1) == 0) {
+        px.push_back(uniform(rng, -0.05, 0.05));
+        py.push_back(-1.);
+        pz.push_back(uniform(rng, -0.05, 0.05));
+      } else {
+        float phi = uniform(rng, -M_PI, 0.);
+        px.push_back(cos(phi));
+        py.push_back(sin(phi));
+        pz.push_back(uniform(rng, -0.01, 0.01));
+      }
+    }
+    CosmicPairTagger tagger(0.1);
+    while (state.keepRunning()) {
+      tagger.clear();
+      for (unsigned int i = 0; i < px.size(); i++) tagger.add(i, px[i], py[i], pz[i]);
+      doNotOptimize(tagger.tag());
+    }
+    state.setItemsProcessed(state.iterations() * px.size());
+  }
+
+  void BM_DimuonPairs(BenchState& state) {
+    SyntheticEvent event;
+    generate(event, state.range(0), 0, 0);
+    DimuonPairBuilder pairs;
+    while (state.keepRunning()) {
+      pairs.clear();
+      for (unsigned int i = 0; i < event.muons.size(); i++)
+        pairs.add(i, event.muons[i].px, event.muons[i].py, event.muons[i].pz, i % 2 ? 1 : -1);
+      pairs.build();
+      doNotOptimize(pairs);
+    }
+    state.setItemsProcessed(state.iterations() * event.muons.size());
+  }
+
+  // args: muon times per iteration; the old loop over the 50 x 15 cuts and TimingCutScan
+  void BM_CutScanLoop(BenchState& state) {
+    mt19937 rng(6789);
+    vector<float> times;
+    vector<int> nDofs;
+    for (int i = 0; i < state.range(0); i++) {
+      times.push_back(uniform(rng, -60., 60.));
+      nDofs.push_back(pick(rng, 20));
+    }
+    vector<unsigned long long> counts(50 * 15, 0);
+    while (state.keepRunning())
+      for (unsigned int k = 0; k < times.size(); k++)
+        for (int ii = 0; ii < 50; ii++)
+          for (int jj = 0; jj < 15; jj++)
+            if (nDofs[k] > jj && fabs(times[k]) > ii) counts[ii * 15 + jj]++;
+    doNotOptimize(counts);
+    state.setItemsProcessed(state.iterations() * times.size());
+  }
+
+  void BM_CutScan(BenchState& state) {
+    mt19937 rng(6789);
+    vector<float> times;
+    vector<int> nDofs;
+    for (int i = 0; i < state.range(0); i++) {
+      times.push_back(uniform(rng, -60., 60.));
+      nDofs.push_back(pick(rng, 20));
+    }
+    TimingCutScan scan(50, 15);
+    while (state.keepRunning())
+      for (unsigned int k = 0; k < times.size(); k++) scan.fill(times[k], nDofs[k]);
+    doNotOptimize(scan);
+    state.setItemsProcessed(state.iterations() * times.size());
+  }
+
+  // args: hits per muon
+  void BM_TimingFit(BenchState& state) {
+    mt19937 rng(4321);
+    vector<float> dist, t0;
+    for (int i = 0; i < state.range(0); i++) {
+      dist.push_back(uniform(rng, 400., 1000.));
+      t0.push_back(uniform(rng, -3., 3.));
+    }
+    TimingFitter fitter(4.);
+    while (state.keepRunning()) {
+      fitter.clear();
+      for (unsigned int i = 0; i < dist.size(); i++) fitter.addHit(dist[i], t0[i], 2.);
+      TimingFitResult result = fitter.fit();
+      doNotOptimize(result);
+    }
+    state.setItemsProcessed(state.iterations() * dist.size());
+  }
+
+  vector<Bench> benchmarks() {
+    vector<vector<int> > muonsSegments = {{2, 100}, {2, 1000}, {10, 100}, {10, 1000}, {50, 5000}};
+    vector<vector<int> > muonsCandidates = {{2, 10}, {10, 100}, {50, 1000}};
+    vector<vector<int> > muons = {{2}, {10}, {50}, {200}};
+    return {
+      {"BM_DTSegments", BM_DTSegments, muonsSegments},
+      {"BM_DTSegmentsLinear", BM_DTSegmentsLinear, muonsSegments},
+      {"BM_CSCSegments", BM_CSCSegments, muonsSegments},
+      {"BM_RPCHits", BM_RPCHits, muonsSegments},
+      {"BM_RecHits", BM_RecHits, muonsSegments},
+      {"BM_HitCounterBuild", BM_HitCounterBuild, {{100}, {1000}, {5000}}},
+      {"BM_TruthMatch", BM_TruthMatch, muonsCandidates},
+      {"BM_L1Match", BM_L1Match, muonsCandidates},
+      {"BM_CosmicPairs", BM_CosmicPairs, muons},
+      {"BM_CosmicShower", BM_CosmicShower, {{10, 0}, {50, 0}, {200, 0}, {1000, 0}, {10, 1}, {50, 1}, {200, 1}, {1000, 1}}},
+      {"BM_DimuonPairs", BM_DimuonPairs, muons},
+      {"BM_CutScanLoop", BM_CutScanLoop, {{1}, {100}}},
+      {"BM_CutScan", BM_CutScan, {{1}, {100}}},
+      {"BM_TimingFit", BM_TimingFit, {{8}, {24}, {48}}}
+    };
+  }
+
+}
+
+int main(int argc, char** argv) {
+  string filter;
+  double minTime = 0.5;
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "--filter=", 9)) filter = argv[i] + 9;
+    else if (!strncmp(argv[i], "--min_time=", 11)) minTime = atof(argv[i] + 11);
+    else {
+      fprintf(stderr, "Usage: %s [--filter=substring] [--min_time=seconds]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("%-36s %12s %17s %21s\n", "Benchmark", "Iterations", "Time/iteration", "Rate");
+  for (const Bench& bench : benchmarks())
+    for (const vector<int>& args : bench.args)
+      if (filter.empty() || benchName(bench, args).find(filter) != string::npos)
+        runBench(bench, args, minTime);
+  return 0;
+}
@@ -0,0 +1,76 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofIndex
+//
+/**\file hscptofIndex.cc
+
+ Description: Look up HSCP candidates in the event index sidecar
+
+ Implementation:
+     Reads an index written by MuonTimingAnalyzer or MuonNtupleFiller
+     (indexSelection/indexOut) with EventIndexReader. Given events, each is
+     found with a binary search over the sorted records and its input file
+     and candidates are printed; without events the whole index is
+     listed. The "run:lumi:event" column can be given to edmPickEvents.py
+     or to the eventsToProcess of a PoolSource reading the printed file.
+
+ Usage:
+     hscptofIndex index.bin [run:lumi:event ...]
+*/
+
+#include "UserCode/HSCPTOF/interface/EventIndex.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  void print(const EventIndexReader& index, const EventIndexRecord& r) {
+    printf("%u:%u:%" PRIu64 "  %s  muon %u  pt %.1f eta %.2f phi %.2f  cmb %.1f+-%.1f ns (%d)  rpc %.1f ns (%d)\n",
+           r.run, r.lumi, r.event, r.file < index.files().size() ? index.files()[r.file].c_str() : "?",
+           r.muon, r.pt, r.eta, r.phi, r.cmbTime, r.cmbTimeErr, r.cmbNdof, r.rpcTime, r.rpcNdof);
+  }
+
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s index.bin [run:lumi:event ...]\n", argv[0]);
+    return 1;
+  }
+
+  try {
+    EventIndexReader index(argv[1]);
+    if (argc == 2) {
+      printf("%" PRIu64 " candidates in %zu input file(s)\n", index.size(), index.files().size());
+      for (uint64_t i = 0; i < index.size(); i++) print(index, index.record(i));
+      return 0;
+    }
+
+    int missing = 0;
+    for (int i = 2; i < argc; i++) {
+      unsigned int run = 0, lumi = 0;
+      unsigned long long event = 0;
+      if (sscanf(argv[i], "%u:%u:%llu", &run, &lumi, &event) != 3) {
+        fprintf(stderr, "Bad event %s, expected run:lumi:event\n", argv[i]);
+        return 1;
+      }
+      vector<EventIndexRecord> records = index.find(run, lumi, event);
+      if (records.empty()) {
+        printf("%s  not in the index\n", argv[i]);
+        missing++;
+      }
+      for (const EventIndexRecord& r : records) print(index, r);
+    }
+    return missing ? 2 : 0;
+  } catch (const exception& e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
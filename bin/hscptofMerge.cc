@@ -0,0 +1,371 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofMerge
+//
+/**\file hscptofMerge.cc
+
+ Description: Merge the output files of the HSCPTOF modules
+              (muonTimingAnalyzer.root, aodTimingAnalyzer.root, muonNtuple.root)
+
+ Implementation:
+     The list of histograms and trees is taken from the first readable input,
+     including all subdirectories (dt, csc, combined, differences).
+     Histograms are summed in parallel: every worker thread adds up its own
+     share of the input files and the partial sums are added at the end.
+     The binning of every input is checked against the first input, and that
+     of every partial sum against the total before it is added.
+     Trees (MuTree) are concatenated with fast cloning, i.e. the compressed
+     baskets are copied without being unzipped and recompressed.
+     Inputs that cannot be opened, were not closed properly or miss some of
+     the expected objects are reported and left out of the merge.
+
+ Usage:
+     hscptofMerge [-j nThreads] output.root input1.root [input2.root ...]
+     hscptofMerge [-j nThreads] output.root @fileList.txt
+
+     Exit code is 0 if all inputs were merged, 2 if some inputs were skipped
+     or only partially merged (histograms added, trees not) and 1 if no output
+     could be produced.
+*/
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TDirectory.h>
+#include <TKey.h>
+#include <TAxis.h>
+#include <TClass.h>
+#include <TH1.h>
+#include <THnBase.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  struct MergeLayout {
+    vector<string> histograms;   // full paths, e.g. "dt/hi_dttime_vtx" (TH1 or THnSparse)
+    vector<string> trees;        // full paths, e.g. "MuTree"
+  };
+
+  struct InputStatus {
+    bool good;           // histograms added
+    string reason;       // why not
+    string treeProblem;  // histograms added, but the trees could not be copied
+  };
+
+  string joinPath(const string& dir, const string& name) {
+    return dir.empty() ? name : dir + "/" + name;
+  }
+
+  // collect histogram and tree paths below a directory; only the highest cycle of each key is used
+  void scanDirectory(TDirectory* dir, const string& path, MergeLayout& layout) {
+    set<string> seen;
+    TIter next(dir->GetListOfKeys());
+    while (TKey* key = (TKey*)next()) {
+      string name = key->GetName();
+      if (!seen.insert(name).second) continue;
+      TClass* cl = TClass::GetClass(key->GetClassName());
+      if (!cl) continue;
+      if (cl->InheritsFrom(TDirectory::Class())) {
+        TDirectory* sub = dir->GetDirectory(name.c_str());
+        if (sub) scanDirectory(sub, joinPath(path, name), layout);
+      } else if (cl->InheritsFrom(TTree::Class())) {
+        layout.trees.push_back(joinPath(path, name));
+      } else if (cl->InheritsFrom(TH1::Class()) || cl->InheritsFrom(THnBase::Class())) {
+        layout.histograms.push_back(joinPath(path, name));
+      }
+    }
+  }
+
+  bool sameAxis(const TAxis* a1, const TAxis* a2) {
+    return a1->GetNbins() == a2->GetNbins() && a1->GetXmin() == a2->GetXmin() && a1->GetXmax() == a2->GetXmax();
+  }
+
+  // histograms can be merged if they have the same bin layout
+  bool compatible(TObject* sum, TObject* h) {
+    if (TH1* h1 = dynamic_cast<TH1*>(sum)) {
+      TH1* h2 = dynamic_cast<TH1*>(h);
+      return h2 && h1->GetDimension() == h2->GetDimension() && sameAxis(h1->GetXaxis(), h2->GetXaxis())
+          && sameAxis(h1->GetYaxis(), h2->GetYaxis()) && sameAxis(h1->GetZaxis(), h2->GetZaxis());
+    }
+    THnBase* hn1 = dynamic_cast<THnBase*>(sum);
+    THnBase* hn2 = dynamic_cast<THnBase*>(h);
+    if (!hn1 || !hn2 || hn1->GetNdimensions() != hn2->GetNdimensions()) return false;
+    for (int idim = 0; idim < hn1->GetNdimensions(); idim++)
+      if (!sameAxis(hn1->GetAxis(idim), hn2->GetAxis(idim))) return false;
+    return true;
+  }
+
+  void add(TObject* sum, TObject* h) {
+    if (TH1* h1 = dynamic_cast<TH1*>(sum)) h1->Add((TH1*)h);
+    else ((THnBase*)sum)->Add((THnBase*)h);
+  }
+
+  TObject* clone(TObject* h) {
+    TObject* copy = h->Clone();
+    if (TH1* h1 = dynamic_cast<TH1*>(copy)) h1->SetDirectory(0);
+    return copy;
+  }
+
+  // open an input and check that it was closed properly
+  TFile* openInput(const string& name, string& reason) {
+    TFile* file = TFile::Open(name.c_str(), "READ");
+    if (!file) {
+      reason = "cannot open file";
+      return 0;
+    }
+    if (file->IsZombie()) {
+      reason = "not a readable ROOT file";
+      delete file;
+      return 0;
+    }
+    if (file->TestBit(TFile::kRecovered)) {
+      reason = "file was not closed properly (recovered keys)";
+      delete file;
+      return 0;
+    }
+    return file;
+  }
+
+  // sum the histograms of a share of the inputs into the worker's partial sums;
+  // reference: the histograms of the first input, whose binning every input must have
+  void addInputs(const vector<string>& inputs, const vector<size_t>& share, const MergeLayout& layout,
+                 const vector<TObject*>& reference, vector<TObject*>& sums, vector<InputStatus>& status) {
+
+    for (size_t ifile : share) {
+      string reason;
+      unique_ptr<TFile> file(openInput(inputs[ifile], reason));
+      if (!file) {
+        status[ifile] = {false, reason};
+        continue;
+      }
+
+      // read everything first, so that an incomplete file does not leave a partial contribution
+      vector<TObject*> hists(layout.histograms.size(), 0);
+      for (size_t ih = 0; ih < layout.histograms.size() && reason.empty(); ih++) {
+        hists[ih] = file->Get(layout.histograms[ih].c_str());
+        if (!hists[ih]) reason = "missing histogram " + layout.histograms[ih];
+      }
+      for (size_t it = 0; it < layout.trees.size() && reason.empty(); it++)
+        if (!dynamic_cast<TTree*>(file->Get(layout.trees[it].c_str())))
+          reason = "missing tree " + layout.trees[it];
+
+      for (size_t ih = 0; ih < hists.size() && reason.empty(); ih++)
+        if ((reference[ih] && !compatible(reference[ih], hists[ih])) || (sums[ih] && !compatible(sums[ih], hists[ih])))
+          reason = "incompatible binning of " + layout.histograms[ih];
+
+      if (reason.empty()) {
+        for (size_t ih = 0; ih < hists.size(); ih++) {
+          if (!sums[ih]) sums[ih] = clone(hists[ih]);
+          else add(sums[ih], hists[ih]);
+        }
+        status[ifile] = {true, ""};
+      } else status[ifile] = {false, reason};
+
+      for (TObject* h : hists) delete h;
+      file->Close();
+    }
+  }
+
+  TDirectory* makeDirectory(TFile* out, const string& path) {
+    size_t slash = path.rfind('/');
+    if (slash == string::npos) return out;
+    string dirName = path.substr(0, slash);
+    TDirectory* dir = out->GetDirectory(dirName.c_str());
+    if (!dir) {
+      TDirectory* parent = makeDirectory(out, dirName);
+      dir = parent->mkdir(dirName.substr(dirName.rfind('/') + 1).c_str());
+    }
+    return dir;
+  }
+
+  string baseName(const string& path) {
+    size_t slash = path.rfind('/');
+    return (slash == string::npos) ? path : path.substr(slash + 1);
+  }
+
+  void usage() {
+    cerr << "Usage: hscptofMerge [-j nThreads] output.root input1.root [input2.root ...]" << endl;
+    cerr << "       hscptofMerge [-j nThreads] output.root @fileList.txt" << endl;
+  }
+
+}
+
+int main(int argc, char** argv) {
+
+  unsigned int nThreads = thread::hardware_concurrency();
+  string output;
+  vector<string> inputs;
+
+  for (int iarg = 1; iarg < argc; iarg++) {
+    string arg = argv[iarg];
+    if (arg == "-j" && iarg + 1 < argc) {
+      nThreads = atoi(argv[++iarg]);
+    } else if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    } else if (output.empty()) {
+      output = arg;
+    } else if (arg[0] == '@') {
+      ifstream list(arg.substr(1).c_str());
+      string line;
+      while (list >> line)
+        if (line[0] != '#') inputs.push_back(line);
+    } else inputs.push_back(arg);
+  }
+
+  if (output.empty() || inputs.empty()) {
+    usage();
+    return 1;
+  }
+  if (nThreads < 1) nThreads = 1;
+  if (nThreads > inputs.size()) nThreads = inputs.size();
+
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(kFALSE);
+
+  // take the layout and the reference binning from the first readable input
+  MergeLayout layout;
+  vector<TObject*> reference;
+  vector<InputStatus> status(inputs.size(), InputStatus{false, "not processed"});
+  size_t first = 0;
+  for (; first < inputs.size(); first++) {
+    string reason;
+    unique_ptr<TFile> file(openInput(inputs[first], reason));
+    if (!file) {
+      status[first] = {false, reason};
+      continue;
+    }
+    scanDirectory(file.get(), "", layout);
+    for (const string& path : layout.histograms) {
+      TObject* h = file->Get(path.c_str());
+      reference.push_back(h ? clone(h) : 0);
+      delete h;
+    }
+    file->Close();
+    break;
+  }
+
+  if (first == inputs.size()) {
+    cerr << " No readable input among " << inputs.size() << " files." << endl;
+    return 1;
+  }
+
+  cout << " Merging " << inputs.size() << " files with " << nThreads << " threads: "
+       << layout.histograms.size() << " histograms, " << layout.trees.size() << " trees." << endl;
+
+  // distribute the inputs round-robin over the workers
+  vector<vector<size_t> > shares(nThreads);
+  for (size_t ifile = first; ifile < inputs.size(); ifile++)
+    shares[ifile % nThreads].push_back(ifile);
+
+  vector<vector<TObject*> > partials(nThreads, vector<TObject*>(layout.histograms.size(), 0));
+  vector<thread> workers;
+  for (unsigned int iw = 0; iw < nThreads; iw++)
+    workers.emplace_back(addInputs, cref(inputs), cref(shares[iw]), cref(layout),
+                         cref(reference), ref(partials[iw]), ref(status));
+  for (auto& worker : workers) worker.join();
+  for (TObject* h : reference) delete h;
+
+  // add up the partial sums; a partial sum that does not fit the total is dropped with all its inputs
+  vector<TObject*> sums(layout.histograms.size(), 0);
+  for (unsigned int iw = 0; iw < nThreads; iw++) {
+    string reason;
+    for (size_t ih = 0; ih < sums.size() && reason.empty(); ih++)
+      if (sums[ih] && partials[iw][ih] && !compatible(sums[ih], partials[iw][ih]))
+        reason = "incompatible binning of " + layout.histograms[ih] + " with the other inputs";
+    if (!reason.empty())
+      for (size_t ifile : shares[iw])
+        if (status[ifile].good) status[ifile] = {false, reason};
+
+    for (size_t ih = 0; ih < sums.size(); ih++) {
+      TObject* h = partials[iw][ih];
+      if (!h) continue;
+      if (!reason.empty()) delete h;
+      else if (!sums[ih]) sums[ih] = h;
+      else {
+        add(sums[ih], h);
+        delete h;
+      }
+    }
+  }
+
+  unique_ptr<TFile> out(TFile::Open(output.c_str(), "RECREATE"));
+  if (!out || out->IsZombie()) {
+    cerr << " Cannot create output file " << output << endl;
+    return 1;
+  }
+
+  for (size_t ih = 0; ih < sums.size(); ih++) {
+    if (!sums[ih]) continue;
+    TDirectory* dir = makeDirectory(out.get(), layout.histograms[ih]);
+    dir->cd();
+    sums[ih]->Write(baseName(layout.histograms[ih]).c_str(), TObject::kOverwrite);
+    delete sums[ih];
+  }
+
+  // concatenate the trees by copying the compressed baskets; the histograms of the inputs
+  // are already written, so an input that fails here is reported as partially merged
+  for (const string& treePath : layout.trees) {
+    TTree* merged = 0;
+    TDirectory* dir = makeDirectory(out.get(), treePath);
+    for (size_t ifile = 0; ifile < inputs.size(); ifile++) {
+      if (!status[ifile].good) continue;
+      string reason;
+      unique_ptr<TFile> file(openInput(inputs[ifile], reason));
+      if (!file) {
+        status[ifile].treeProblem = reason;
+        continue;
+      }
+      TTree* in = (TTree*)file->Get(treePath.c_str());
+      if (!merged) {
+        dir->cd();
+        merged = in->CloneTree(0);
+        merged->SetDirectory(dir);
+      }
+      if (merged->CopyEntries(in, -1, "fast") < 0)
+        status[ifile].treeProblem = "failed to copy " + treePath + " (tree only partially merged)";
+      file->Close();
+    }
+    if (merged) {
+      dir->cd();
+      merged->Write("", TObject::kOverwrite);
+      cout << " " << treePath << ": " << merged->GetEntries() << " entries" << endl;
+      delete merged;
+    }
+  }
+
+  out->Close();
+
+  int nBad = 0, nPartial = 0;
+  for (size_t ifile = 0; ifile < inputs.size(); ifile++)
+    if (!status[ifile].good) {
+      if (!nBad) cerr << " Skipped inputs:" << endl;
+      cerr << "   " << inputs[ifile] << " : " << status[ifile].reason << endl;
+      nBad++;
+    }
+  for (size_t ifile = 0; ifile < inputs.size(); ifile++)
+    if (status[ifile].good && !status[ifile].treeProblem.empty()) {
+      if (!nPartial) cerr << " Partially merged inputs (histograms added, trees not):" << endl;
+      cerr << "   " << inputs[ifile] << " : " << status[ifile].treeProblem << endl;
+      nPartial++;
+    }
+
+  cout << " Merged " << inputs.size() - nBad - nPartial << " of " << inputs.size() << " files into " << output;
+  if (nPartial) cout << ", " << nPartial << " partially";
+  cout << endl;
+  return (nBad || nPartial) ? 2 : 0;
+}
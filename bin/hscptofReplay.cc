@@ -0,0 +1,277 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofReplay
+//
+/**\file hscptofReplay.cc
+
+ Description: Run the HSCPTOF analysis kernels on recorded event snapshots
+
+ Implementation:
+     The snapshots written by SnapshotRecorder are read into memory and
+     passed, event by event, through the same steps as the modules:
+     pt/eta/requireId selection (SelectionExpression over the recorded
+     MuonTimingCuts variables), cosmic pair tagging, DT/CSC segment and RPC
+     hit counting, truth and L1 matching, the time cut scans and the dimuon
+     pairs (global tracks, both muons selected, as hi_glb_mass_os/ss of the
+     timing analyzers). With --repeat the events are processed several times, so the
+     rate is measured without the file reading.
+     The printed counts and the checksum of all the results do not depend on
+     the speed: two builds agree if they print the same checksum.
+
+ Usage:
+     hscptofReplay [options] snapshots.bin [more.bin ...]
+       --ptcut=GeV       muon pt cut (default 5)
+       --eta=min,max     |eta| window (default 0,2.5)
+       --id=expression   requireId over the recorded variables, e.g. "isLoose && abs(dtTime)<20"
+       --angle=rad       cosmic back-to-back angle (default 0.02)
+       --repeat=N        process the events N times (default 1)
+       --max=N           read at most N events
+*/
+
+#include "UserCode/HSCPTOF/interface/EventSnapshot.h"
+#include "UserCode/HSCPTOF/interface/SelectionExpression.h"
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
+#include "UserCode/HSCPTOF/interface/MuonCandidateMatcher.h"
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+#include "UserCode/HSCPTOF/interface/TimingCutScan.h"
+#include "UserCode/HSCPTOF/interface/DimuonPairBuilder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  struct ReplayOptions {
+    double ptCut, etaMin, etaMax, angle;
+    string id;
+    unsigned int repeat;
+    unsigned long long maxEvents;
+  };
+
+  struct ReplayCounts {
+    unsigned long long events, muons, selected, cosmicEvents, cosmicPairs;
+    unsigned long long segments[4], rpcHits[4];
+    unsigned long long truthMatched, l1Matches, dimuons, oppositeSign;
+    unsigned long long checksum;
+  };
+
+  // FNV-1a over the results, in processing order
+  void hash(unsigned long long& h, long long value) {
+    for (int i = 0; i < 8; i++) {
+      h ^= (value >> (8 * i)) & 0xff;
+      h *= 1099511628211ULL;
+    }
+  }
+
+  class Replay {
+  public:
+    Replay(const ReplayOptions& options, const vector<string>& variableNames)
+      : theOptions(options),
+        theSelection(options.id, variableNames),
+        theNVariables(variableNames.size()),
+        theTagger(options.angle),
+        theRpcScan(50, 1), theCscScan(50, 1), theDtScan(50, 15), theCmbScan(50, 15)
+    {
+      memset(&theCounts, 0, sizeof(theCounts));
+      theCounts.checksum = 14695981039346656037ULL;
+    }
+
+    void process(const EventSnapshot& event);
+    const ReplayCounts& counts() const { return theCounts; }
+    unsigned long long scanEntries() const {
+      return theRpcScan.entries() + theCscScan.entries() + theDtScan.entries() + theCmbScan.entries();
+    }
+
+  private:
+    ReplayOptions theOptions;
+    SelectionExpression theSelection;
+    unsigned int theNVariables;
+    CosmicPairTagger theTagger;
+    MuonHitCounter theHitCounter;
+    MuonCandidateMatcher theTpMatcher, theL1Matcher;
+    DimuonPairBuilder theDimuons;
+    TimingCutScan theRpcScan, theCscScan, theDtScan, theCmbScan;
+    vector<MuonCandidateMatcher::Direction> theLooseMuons;
+    vector<MuonHitCounter::ChamberMatch> theMatches;
+    vector<MuonHitCounter::TrackHit> theRPCTrackHits;
+    vector<unsigned int> theL1Matches;
+    vector<double> theVariables;
+    vector<bool> theSelected;
+    ReplayCounts theCounts;
+  };
+
+  void Replay::process(const EventSnapshot& event) {
+    ReplayCounts& c = theCounts;
+    c.events++;
+    c.muons += event.muons.size();
+
+    // the collections of the event, once for all the muons
+    theHitCounter.clear();
+    for (const EventSnapshot::Segment& seg : event.segments) {
+      if (seg.detector == MuonHitCounter::DT) theHitCounter.addDTSegment(seg.chamber, seg.x, seg.y);
+      else theHitCounter.addCSCSegment(seg.chamber, seg.x, seg.y, seg.nHits);
+    }
+    for (const EventSnapshot::RPCHit& hit : event.rpcHits) theHitCounter.addRPCHit(hit.roll, hit.x, hit.bx);
+    theHitCounter.build();
+
+    theTpMatcher.clear();
+    for (unsigned int i = 0; i < event.tpMuons.size(); i++)
+      theTpMatcher.add(i, event.tpMuons[i].eta, event.tpMuons[i].phi);
+    theL1Matcher.clear();
+    for (unsigned int i = 0; i < event.l1.size(); i++) theL1Matcher.add(i, event.l1[i].eta, event.l1[i].phi);
+
+    // cosmic pairs and the muons competing for the L1 candidates
+    theTagger.clear();
+    theLooseMuons.clear();
+    for (unsigned int i = 0; i < event.muons.size(); i++) {
+      const EventSnapshot::Muon& mu = event.muons[i];
+      if (mu.hasTrk) theTagger.add(i, mu.trkPx, mu.trkPy, mu.trkPz);
+      if (mu.pt > theOptions.ptCut && mu.isLoose) {
+        MuonCandidateMatcher::Direction dir = {i, mu.bestEta, mu.bestPhi};
+        theLooseMuons.push_back(dir);
+      }
+    }
+    unsigned int nPairs = theTagger.tag().size();
+    if (nPairs) c.cosmicEvents++;
+    c.cosmicPairs += nPairs;
+    hash(c.checksum, nPairs);
+
+    // all the global muons enter the pairs, as in the timing analyzers
+    theDimuons.clear();
+    theSelected.assign(event.muons.size(), false);
+    theVariables.resize(theNVariables);
+    for (unsigned int i = 0; i < event.muons.size(); i++) {
+      const EventSnapshot::Muon& mu = event.muons[i];
+      if (mu.hasGlb) theDimuons.add(i, mu.glbPx, mu.glbPy, mu.glbPz, mu.glbCharge);
+
+      // segments and RPC hits near the standalone muons
+      if (mu.hasSta) {
+        theMatches.assign(event.matches.begin() + mu.firstMatch, event.matches.begin() + mu.firstMatch + mu.nMatches);
+        theRPCTrackHits.assign(event.rpcTrackHits.begin() + mu.firstRPCHit,
+                               event.rpcTrackHits.begin() + mu.firstRPCHit + mu.nRPCHits);
+        int segments[4] = {0, 0, 0, 0}, rpcHits[4];
+        theHitCounter.countDTSegments(theMatches, segments);
+        theHitCounter.countCSCSegments(theMatches, segments);
+        theHitCounter.countRPCHits(theRPCTrackHits, rpcHits);
+        for (int s = 0; s < 4; s++) {
+          c.segments[s] += segments[s];
+          c.rpcHits[s] += rpcHits[s];
+          hash(c.checksum, segments[s]);
+          hash(c.checksum, rpcHits[s]);
+        }
+
+        theL1Matcher.matchL1(i, mu.bestEta, mu.bestPhi, theLooseMuons, theL1Matches);
+        c.l1Matches += theL1Matches.size();
+        for (unsigned int l1 : theL1Matches) hash(c.checksum, l1);
+      }
+
+      // muon selection of the timing analyzers
+      if (mu.pt < theOptions.ptCut) continue;
+      double eta = fabs(mu.eta);
+      if (eta < theOptions.etaMin || eta > theOptions.etaMax) continue;
+      for (unsigned int k = 0; k < theNVariables; k++) theVariables[k] = event.variables[i * theNVariables + k];
+      if (!theSelection(theVariables.data())) continue;
+      c.selected++;
+      theSelected[i] = true;
+      hash(c.checksum, i);
+
+      int tp = theTpMatcher.matchTruth(mu.hasTrk, mu.trkEta, mu.trkPhi, mu.hasSta, mu.staEta, mu.staPhi);
+      if (tp >= 0) c.truthMatched++;
+      hash(c.checksum, tp);
+
+      if (mu.hasSta || mu.hasGlb) {
+        theRpcScan.fill(mu.rpcTime, mu.rpcNDof > 1 && mu.rpcTimeErr < 1);
+        theCscScan.fill(mu.cscTime, mu.cscNDof ? 1 : 0);
+        theDtScan.fill(mu.dtTime, mu.dtNDof);
+        theCmbScan.fill(mu.cmbTime, mu.cmbNDof);
+      }
+    }
+
+    theDimuons.build();
+    for (unsigned int k = 0; k < theDimuons.nPairs(); k++) {
+      if (!theSelected[theDimuons.first(k)] || !theSelected[theDimuons.second(k)]) continue;
+      c.dimuons++;
+      if (theDimuons.oppositeSign(k)) c.oppositeSign++;
+      hash(c.checksum, (long long)lround(theDimuons.mass(k) * 1000.));
+    }
+  }
+
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions options = {5., 0., 2.5, 0.02, "", 1, 0};
+  vector<string> files;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (!arg.compare(0, 8, "--ptcut=")) options.ptCut = atof(arg.c_str() + 8);
+    else if (!arg.compare(0, 6, "--eta=") && arg.find(',') != string::npos) {
+      options.etaMin = atof(arg.c_str() + 6);
+      options.etaMax = atof(arg.c_str() + arg.find(',') + 1);
+    }
+    else if (!arg.compare(0, 5, "--id=")) options.id = arg.substr(5);
+    else if (!arg.compare(0, 8, "--angle=")) options.angle = atof(arg.c_str() + 8);
+    else if (!arg.compare(0, 9, "--repeat=")) options.repeat = max(1, atoi(arg.c_str() + 9));
+    else if (!arg.compare(0, 6, "--max=")) options.maxEvents = strtoull(arg.c_str() + 6, 0, 10);
+    else if (!arg.compare(0, 2, "--")) {
+      fprintf(stderr, "Unknown option %s\n", arg.c_str());
+      return 1;
+    }
+    else files.push_back(arg);
+  }
+  if (files.empty()) {
+    fprintf(stderr, "Usage: %s [--ptcut=GeV] [--eta=min,max] [--id=expression] [--angle=rad] [--repeat=N] [--max=N] "
+                    "snapshots.bin [...]\n", argv[0]);
+    return 1;
+  }
+
+  try {
+    // all the events in memory, so that the processing is timed alone
+    vector<EventSnapshot> events;
+    vector<string> variableNames;
+    for (const string& file : files) {
+      EventSnapshotReader reader(file);
+      if (variableNames.empty()) variableNames = reader.variableNames();
+      else if (reader.variableNames() != variableNames) {
+        fprintf(stderr, "%s was recorded with different muon variables, skipped\n", file.c_str());
+        continue;
+      }
+      EventSnapshot event;
+      while ((!options.maxEvents || events.size() < options.maxEvents) && reader.read(event)) events.push_back(event);
+    }
+    printf("%zu events read from %zu file(s)\n", events.size(), files.size());
+
+    Replay replay(options, variableNames);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned int r = 0; r < options.repeat; r++)
+      for (const EventSnapshot& event : events) replay.process(event);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const ReplayCounts& c = replay.counts();
+    printf("events processed      %llu (%u pass%s)\n", c.events, options.repeat, options.repeat > 1 ? "es" : "");
+    printf("muons / selected      %llu / %llu\n", c.muons, c.selected);
+    printf("cosmic events / pairs %llu / %llu\n", c.cosmicEvents, c.cosmicPairs);
+    printf("extra segments        %llu %llu %llu %llu\n", c.segments[0], c.segments[1], c.segments[2], c.segments[3]);
+    printf("RPC hits              %llu %llu %llu %llu\n", c.rpcHits[0], c.rpcHits[1], c.rpcHits[2], c.rpcHits[3]);
+    printf("truth matched         %llu\n", c.truthMatched);
+    printf("L1 matches            %llu\n", c.l1Matches);
+    printf("dimuons / OS          %llu / %llu\n", c.dimuons, c.oppositeSign);
+    printf("cut scan entries      %llu\n", replay.scanEntries());
+    printf("checksum              %016llx\n", c.checksum);
+    printf("time                  %.3f s, %.0f events/s\n", seconds, seconds > 0 ? c.events / seconds : 0.);
+  }
+  catch (exception& e) {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,130 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofScaling
+//
+/**\file hscptofScaling.cc
+
+ Description: Collect the thread-scaling benchmark results into one table
+
+ Implementation:
+     Reads the framework job reports written by test/threadScaling.sh
+     (cmsRun -j fjr_<module>_<threads>.xml) and prints, per module and
+     number of threads: events, events/s, the speedup over the 1-thread
+     job, the CPU efficiency (loop CPU time / loop wall time / threads) and
+     the peak RSS from SimpleMemoryCheck. The rows are sorted by module and
+     threads and the numbers have a fixed format, so the tables of two
+     releases can be compared with diff.
+
+ Usage:
+     hscptofScaling fjr_*.xml > scaling.txt
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  struct ScalingResult {
+    string module;
+    unsigned int threads, streams;
+    unsigned long long events;
+    double wallTime, cpuTime, throughput, peakRss;
+  };
+
+  // value of an attribute in an XML tag, empty if missing
+  string attribute(const string& tag, const string& name) {
+    size_t pos = tag.find(name + "=\"");
+    if (pos == string::npos) return "";
+    pos += name.size() + 2;
+    return tag.substr(pos, tag.find('"', pos) - pos);
+  }
+
+  // the <Metric Name="..." Value="..."/> entries of the performance report and the events read
+  bool readReport(const string& file, map<string,double>& metrics, unsigned long long& events) {
+    ifstream in(file.c_str());
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    const string xml = buffer.str();
+
+    events = 0;
+    for (size_t pos = xml.find("<Metric "); pos != string::npos; pos = xml.find("<Metric ", pos + 1)) {
+      string tag = xml.substr(pos, xml.find('>', pos) - pos);
+      string name = attribute(tag, "Name"), value = attribute(tag, "Value");
+      if (!name.empty() && !value.empty()) metrics[name] = atof(value.c_str());
+    }
+    for (size_t pos = xml.find("<EventsRead>"); pos != string::npos; pos = xml.find("<EventsRead>", pos + 1))
+      events += strtoull(xml.c_str() + pos + 12, 0, 10);
+    return true;
+  }
+
+  // fjr_muonTimingAnalyzer_4.xml -> muonTimingAnalyzer
+  string moduleName(const string& file) {
+    string name = file.substr(file.rfind('/') + 1);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".xml") == 0) name.erase(name.size() - 4);
+    if (name.compare(0, 4, "fjr_") == 0) name.erase(0, 4);
+    size_t pos = name.rfind('_');
+    if (pos != string::npos && pos + 1 < name.size()
+        && name.find_first_not_of("0123456789", pos + 1) == string::npos) name.erase(pos);
+    return name;
+  }
+
+  double metric(const map<string,double>& metrics, const string& name) {
+    map<string,double>::const_iterator it = metrics.find(name);
+    return it == metrics.end() ? 0 : it->second;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s fjr_<module>_<threads>.xml [...]\n", argv[0]);
+    return 1;
+  }
+
+  vector<ScalingResult> results;
+  for (int i = 1; i < argc; i++) {
+    map<string,double> metrics;
+    ScalingResult r;
+    if (!readReport(argv[i], metrics, r.events)) {
+      fprintf(stderr, "Cannot read %s, skipped\n", argv[i]);
+      continue;
+    }
+    r.module = moduleName(argv[i]);
+    r.threads = max(1., metric(metrics, "NumberOfThreads"));
+    r.streams = max(1., metric(metrics, "NumberOfStreams"));
+    r.wallTime = metric(metrics, "TotalLoopTime");
+    r.cpuTime = metric(metrics, "TotalLoopCPU");
+    r.throughput = metric(metrics, "EventThroughput");
+    if (r.throughput <= 0 && r.wallTime > 0) r.throughput = r.events / r.wallTime;
+    r.peakRss = metric(metrics, "PeakValueRss");
+    results.push_back(r);
+  }
+  sort(results.begin(), results.end(), [](const ScalingResult& a, const ScalingResult& b) {
+    return a.module != b.module ? a.module < b.module : a.threads < b.threads;
+  });
+
+  // the rate of the job with the fewest threads (normally 1) is the reference of the speedup
+  map<string,double> reference;
+  for (const ScalingResult& r : results)
+    if (!reference.count(r.module)) reference[r.module] = r.throughput;
+
+  printf("%-24s %7s %7s %10s %10s %8s %8s %10s\n", "module", "threads", "streams", "events", "events/s",
+         "speedup", "CPU eff", "RSS [MB]");
+  for (const ScalingResult& r : results) {
+    double speedup = reference[r.module] > 0 ? r.throughput / reference[r.module] : 0;
+    double efficiency = r.wallTime > 0 ? r.cpuTime / r.wallTime / r.threads : 0;
+    printf("%-24s %7u %7u %10llu %10.1f %8.2f %8.2f %10.1f\n", r.module.c_str(), r.threads, r.streams,
+           r.events, r.throughput, speedup, efficiency, r.peakRss);
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+// -*- C++ -*-
+//
+// Package:    HSCPTOF
+// Program:    hscptofStats
+//
+/**\file hscptofStats.cc
+
+ Description: Merge and print the streaming timing statistics of the timing analyzers
+
+ Implementation:
+     Reads the stats/chamberTimeStats and stats/etaPhiTimeStats tables
+     (timingStats=True) of all the inputs and merges them cell by cell with
+     TimingCellStats::addTable: Welford moments are combined exactly, the
+     KLL sketches level by level. Rows of the same cell repeated in one file
+     (tables concatenated by hscptofMerge) are merged the same way. The
+     sketches only merge with the same k: the first table read sets it and
+     an input with a table of another k (timingStatsK) is skipped whole. Prints
+     one line per cell: n, mean, RMS and the 16/50/84% quantiles; with -o
+     the merged tables are also written, in the same format.
+
+ Usage:
+     hscptofStats [-t chamber|etaphi] [-o merged.root] input1.root [input2.root ...]
+*/
+
+#include "UserCode/HSCPTOF/interface/TimingCellStats.h"
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+  struct StatsTable {
+    const char* name;
+    const char* title;
+    const char* option;
+  };
+
+  const StatsTable theTables[] = {
+    {"chamberTimeStats", "Segment time per DT/CSC chamber", "chamber"},
+    {"etaPhiTimeStats", "Combined time at vertex per eta/phi cell", "etaphi"}
+  };
+  const int nTables = sizeof(theTables) / sizeof(theTables[0]);
+
+  void print(const StatsTable& table, const TimingCellStats& stats) {
+    printf("%s\n", table.name);
+    printf("%-32s %10s %9s %9s %9s %9s %9s\n", "cell", "n", "mean", "rms", "q16", "q50", "q84");
+    for (unsigned int cell = 0; cell < stats.size(); cell++) {
+      const TimingMoments& m = stats.moments(cell);
+      if (!m.n) continue;
+      const QuantileSketch& s = stats.sketch(cell);
+      string label = stats.label(cell);
+      if (label.empty()) label = to_string(cell);
+      printf("%-32s %10lu %9.3f %9.3f %9.3f %9.3f %9.3f\n", label.c_str(), m.n, m.mean, m.rms(),
+             s.quantile(0.16), s.quantile(0.5), s.quantile(0.84));
+    }
+  }
+
+}
+
+int main(int argc, char** argv) {
+  string only, output;
+  vector<string> inputs;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-t") && i + 1 < argc) only = argv[++i];
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+      else inputs.push_back(argv[i]);
+  }
+  if (inputs.empty()) {
+    fprintf(stderr, "Usage: %s [-t chamber|etaphi] [-o merged.root] input1.root [input2.root ...]\n", argv[0]);
+    return 1;
+  }
+
+  // the cells are sized by the rows read, k is the one of the first table
+  vector<TimingCellStats> stats(nTables, TimingCellStats(0, 0));
+  int nRead = 0;
+  for (const string& input : inputs) {
+    TFile* file = TFile::Open(input.c_str());
+    if (!file || file->IsZombie()) {
+      fprintf(stderr, "Cannot open %s, skipped\n", input.c_str());
+      delete file;
+      continue;
+    }
+    // merged into a copy, kept only if all the tables of the file are accepted
+    vector<TimingCellStats> merged(stats);
+    bool found = false, failed = false;
+    for (int it = 0; it < nTables && !failed; it++) {
+      TTree* tree = dynamic_cast<TTree*>(file->Get((string("stats/") + theTables[it].name).c_str()));
+      try {
+        if (tree && merged[it].addTable(tree)) found = true;
+      }
+      catch (invalid_argument& e) {
+        fprintf(stderr, "%s in %s, skipped\n", e.what(), input.c_str());
+        failed = true;
+      }
+    }
+    if (found && !failed) {
+      stats.swap(merged);
+      nRead++;
+    }
+    else if (!failed) fprintf(stderr, "No timing statistics in %s (timingStats=False?), skipped\n", input.c_str());
+    delete file;
+  }
+  if (!nRead) return 1;
+
+  for (int it = 0; it < nTables; it++)
+    if (only.empty() || only == theTables[it].option) print(theTables[it], stats[it]);
+
+  if (!output.empty()) {
+    TFile out(output.c_str(), "recreate");
+    if (out.IsZombie()) {
+      fprintf(stderr, "Cannot create %s\n", output.c_str());
+      return 1;
+    }
+    out.mkdir("stats");
+    out.cd("stats");
+    for (int it = 0; it < nTables; it++) {
+      TTree* tree = stats[it].table(theTables[it].name, theTables[it].title);
+      tree->Write();
+      delete tree;
+    }
+    out.Close();
+  }
+  return nRead == (int)inputs.size() ? 0 : 2;
+}
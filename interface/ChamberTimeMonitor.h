@@ -0,0 +1,62 @@
+#ifndef UserCode_HSCPTOF_ChamberTimeMonitor_H
+#define UserCode_HSCPTOF_ChamberTimeMonitor_H
+
+/** \class ChamberTimeMonitor
+ *  Segment time distribution of every DT and CSC chamber in one contiguous
+ *  [chamber][time bin] array of counters, instead of one TH1F per chamber.
+ *
+ *  Chambers are numbered with MuonChamberIndex; each row has an underflow
+ *  (bin 0) and an overflow (bin nBins+1) counter, so a fill is one
+ *  increment. Written at the end as one TH2F (chamber index vs time) and a
+ *  per-chamber summary (entries, mean, RMS and median of the in-range bins).
+ */
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class TH2F;
+
+class ChamberTimeMonitor {
+public:
+  struct Summary {
+    unsigned long entries;       // all fills, including under/overflow
+    unsigned long underflow, overflow;
+    float mean, rms, median;     // of the in-range bins [ns]
+  };
+
+  ChamberTimeMonitor(unsigned int nBins, float tMin, float tMax);
+
+  /// chamber: MuonChamberIndex, -1 is ignored
+  void fill(int chamber, float time) {
+    if (chamber < 0) return;
+    unsigned int bin = 0;
+    if (time >= theMax) bin = theNBins + 1;
+      else if (time >= theMin) bin = 1 + std::min(theNBins - 1, (unsigned int)((time - theMin) * theScale));
+    theCounts[chamber * theStride + bin]++;
+  }
+
+  void merge(const ChamberTimeMonitor& other);
+
+  unsigned int nBins() const { return theNBins; }
+  /// bin 0 is the underflow, nBins+1 the overflow
+  unsigned int count(int chamber, unsigned int bin) const { return theCounts[chamber * theStride + bin]; }
+  Summary summary(int chamber) const;
+  size_t bytes() const { return theCounts.size() * sizeof(unsigned int); }
+
+  /// chamber index on x, time on y; the caller owns it
+  TH2F* histogram(const char* name, const char* title) const;
+  /// the nWorst chambers with the largest |mean| among those with at least minEntries in range
+  void print(std::ostream& out, unsigned int nWorst, unsigned long minEntries) const;
+
+  /// "DT W-2 MB1 S01" / "CSC ME+1/1 C01"
+  static std::string name(int chamber);
+
+private:
+  unsigned int theNBins, theStride;
+  float theMin, theMax, theScale;
+  std::vector<unsigned int> theCounts;
+};
+
+#endif
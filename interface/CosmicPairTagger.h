@@ -0,0 +1,73 @@
+#ifndef UserCode_HSCPTOF_CosmicPairTagger_H
+#define UserCode_HSCPTOF_CosmicPairTagger_H
+
+/** \class CosmicPairTagger
+ *  Finds back-to-back (cosmic top/bottom) pairs among the muon directions of an event.
+ *
+ *  The deviation from back-to-back, pi minus the opening angle, is compared as a
+ *  cosine (u1.u2 < -cos(maxAngle)), so no acos is needed for the decision.
+ *  A partner u2 of u1 is within |u1+u2| = 2 sin(angle/2) of -u1, so the unit
+ *  vectors are put in cubic cells of [-1,1]^3 at least that wide, sorted by cell,
+ *  and only the 3x3x3 cells around -u1 are searched (binary search on the sorted
+ *  cells, one per row of three). Parallel muons (cosmic showers) or muons sharing
+ *  one coordinate (barrel cosmics, pz~0) do not fall in each other's cells, so the
+ *  cost is O(N log N) plus the pairs actually near back-to-back. Events with few
+ *  directions just check all the pairs with the dot product.
+ */
+
+#include <vector>
+
+class CosmicPairTagger {
+public:
+  struct Pair {
+    unsigned int first, second;   // indices given to add(), first < second
+    float angle;                  // pi - opening angle
+  };
+
+  /// pairs are returned if their deviation from back-to-back is below maxAngle
+  explicit CosmicPairTagger(double maxAngle);
+
+  double maxAngle() const { return theMaxAngle; }
+
+  void clear() { theDirections.clear(); }
+  /// directions with zero momentum are ignored
+  void add(unsigned int index, double px, double py, double pz);
+
+  /// all pairs within maxAngle, ordered by (first, second)
+  const std::vector<Pair>& tag();
+
+  /// number of directions added and of all pairs that can be formed from them
+  unsigned int size() const { return theDirections.size(); }
+  unsigned int nPairs() const { return size() * (size() - 1) / 2; }
+
+  /// number of tagged pairs with a deviation below angleCut (<= maxAngle)
+  static unsigned int count(const std::vector<Pair>& pairs, double angleCut);
+
+private:
+  struct Direction {
+    float x, y, z;
+    unsigned int index;
+    unsigned int cell;
+  };
+  static float deviation(const Direction& d1, const Direction& d2);
+  /// adds the pair if it is within maxAngle
+  void check(const Direction& d1, const Direction& d2);
+  /// the pairs from the cells around the opposite directions
+  void search();
+  /// cell coordinate of a unit vector component, 0..theNCells-1
+  int coordinate(float v) const;
+  unsigned int cell(int ix, int iy, int iz) const { return (ix * theNCells + iy) * theNCells + iz; }
+
+  // up to this many directions all the pairs are checked (faster than the cells, see hscptofBench)
+  static const unsigned int theMaxAllPairs = 64;
+
+  double theMaxAngle;
+  double theMinusCos;     // -cos(maxAngle)
+  int theNCells;          // cells per axis, each at least 2 sin(maxAngle/2) wide
+
+  std::vector<Direction> theDirections;
+  std::vector<unsigned int> theCells;
+  std::vector<Pair> thePairs;
+};
+
+#endif
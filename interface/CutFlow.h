@@ -0,0 +1,44 @@
+#ifndef UserCode_HSCPTOF_CutFlow_H
+#define UserCode_HSCPTOF_CutFlow_H
+
+/** \class CutFlow
+ *  Counts of the objects (events or muons) surviving each stage of a selection.
+ *
+ *  Stages are numbered in the order of the labels; pass(i) is a single
+ *  increment, so the counters can stay in the event loop. Flows of the
+ *  same selection (e.g. one per stream) are added with merge().
+ */
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class TH1F;
+
+class CutFlow {
+public:
+  CutFlow(const std::string& name, const std::vector<std::string>& labels);
+
+  void pass(unsigned int stage) { theCounts[stage]++; }
+
+  unsigned int size() const { return theCounts.size(); }
+  const std::string& name() const { return theName; }
+  const std::string& label(unsigned int stage) const { return theLabels[stage]; }
+  unsigned long long count(unsigned int stage) const { return theCounts[stage]; }
+
+  /// add the counts of another flow with the same stages
+  void merge(const CutFlow& other);
+
+  /// new histogram with one labelled bin per stage, not attached to a directory;
+  /// the caller writes and deletes it
+  TH1F* histogram() const;
+  /// counts, efficiency w.r.t. the previous stage and cumulative efficiency
+  void print(std::ostream& out) const;
+
+private:
+  std::string theName;
+  std::vector<std::string> theLabels;
+  std::vector<unsigned long long> theCounts;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef UserCode_HSCPTOF_DimuonPairBuilder_H
+#define UserCode_HSCPTOF_DimuonPairBuilder_H
+
+/** \class DimuonPairBuilder
+ *  Invariant masses of all the muon pairs of an event.
+ *
+ *  The four-vectors are kept as separate arrays (px, py, pz, E) so that the
+ *  inner loop over the partners of a muon is a plain loop over contiguous
+ *  floats, which the compiler vectorizes. The pairs are stored in the same
+ *  structure-of-arrays form, ordered by (first, second).
+ */
+
+#include <vector>
+
+class DimuonPairBuilder {
+public:
+  void clear();
+  /// index is returned in first/second of the pairs; charge is only used for its sign
+  void add(unsigned int index, double px, double py, double pz, int charge);
+
+  /// compute the masses of all the n(n-1)/2 pairs
+  void build();
+
+  unsigned int size() const { return theIndex.size(); }
+  unsigned int nPairs() const { return theMass.size(); }
+
+  // pair k is made of first(k) and second(k), as given to add()
+  unsigned int first(unsigned int k) const { return theIndex[theFirst[k]]; }
+  unsigned int second(unsigned int k) const { return theIndex[theSecond[k]]; }
+  float mass(unsigned int k) const { return theMass[k]; }
+  bool oppositeSign(unsigned int k) const { return theCharge[theFirst[k]] * theCharge[theSecond[k]] < 0; }
+
+private:
+  // muons
+  std::vector<unsigned int> theIndex;
+  std::vector<int> theCharge;
+  std::vector<float> thePx, thePy, thePz, theE;
+
+  // pairs (positions in the muon arrays)
+  std::vector<unsigned short> theFirst, theSecond;
+  std::vector<float> theMass;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef UserCode_HSCPTOF_EventIndex_H
+#define UserCode_HSCPTOF_EventIndex_H
+
+/** \class EventIndexWriter
+ *  Sidecar index of the interesting candidates of a job, to go back to their
+ *  RECO events without a pick-events search.
+ *
+ *  One fixed-size record per candidate muon: run, lumi, event, input file
+ *  and a summary of the muon. The writer keeps the records in memory
+ *  and writes them sorted by (run, lumi, event, muon) when closed, so
+ *  EventIndexReader finds an event with a binary search over the file
+ *  without reading it all.
+ *  File layout: "HSCPINDX", version 2, record size, number of records,
+ *  number of input files, the file names (length and bytes), the records.
+ *  There is no entry number: a module behind a filter does not see every
+ *  event of its input file, so the event is found there by run:lumi:event.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+struct EventIndexRecord {
+  uint32_t run, lumi;
+  uint64_t event;
+  uint32_t file;         // index in the file names
+  uint32_t muon;         // index in the muon collection
+  float pt, eta, phi;
+  float cmbTime, cmbTimeErr;
+  int32_t cmbNdof;
+  float rpcTime;
+  int32_t rpcNdof;
+
+  bool operator<(const EventIndexRecord& other) const {
+    if (run != other.run) return run < other.run;
+    if (lumi != other.lumi) return lumi < other.lumi;
+    if (event != other.event) return event < other.event;
+    return muon < other.muon;
+  }
+};
+
+class EventIndexWriter {
+public:
+  explicit EventIndexWriter(const std::string& fileName);
+  ~EventIndexWriter();
+
+  /// index of an input file name, added on first use
+  uint32_t file(const std::string& name);
+  void add(const EventIndexRecord& record) { theRecords.push_back(record); }
+  size_t size() const { return theRecords.size(); }
+
+  /// sort and write the records; also done by the destructor
+  void close();
+
+private:
+  std::string theFileName;
+  bool theClosed;
+  std::vector<std::string> theFiles;
+  std::map<std::string, uint32_t> theFileIndex;
+  std::vector<EventIndexRecord> theRecords;
+};
+
+class EventIndexReader {
+public:
+  explicit EventIndexReader(const std::string& fileName);
+
+  const std::vector<std::string>& files() const { return theFiles; }
+  uint64_t size() const { return theSize; }
+
+  EventIndexRecord record(uint64_t i);
+  /// the candidates of one event, empty if it is not in the index
+  std::vector<EventIndexRecord> find(uint32_t run, uint32_t lumi, uint64_t event);
+
+private:
+  std::ifstream theFile;
+  std::string theFileName;
+  std::vector<std::string> theFiles;
+  uint64_t theSize;
+  std::streamoff theOffset;
+};
+
+#endif
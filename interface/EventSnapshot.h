@@ -0,0 +1,113 @@
+#ifndef UserCode_HSCPTOF_EventSnapshot_H
+#define UserCode_HSCPTOF_EventSnapshot_H
+
+/** \class EventSnapshot
+ *  What the HSCPTOF modules read from one event, in plain arrays.
+ *
+ *  Written by the SnapshotRecorder module and read back by hscptofReplay,
+ *  which runs the analysis kernels on it without the framework. Besides the
+ *  kinematics and the times, every muon carries the values of the
+ *  MuonTimingCuts variables (names in the file header), so any requireId
+ *  expression can be evaluated on replay. Only the segments in the chambers
+ *  crossed by a muon and the RPC hits in the rolls of its hits are kept.
+ *
+ *  EventSnapshotWriter/Reader: binary file, a header (magic, version,
+ *  variable names) followed by one length-prefixed record per event. The
+ *  numbers are written in the byte order of the machine. The reader refuses
+ *  an event whose muons point outside its matches or rpcTrackHits arrays.
+ */
+
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct EventSnapshot {
+  struct Muon {
+    float pt, eta, phi;                   // reco::Muon
+    float bestPt, bestEta, bestPhi;       // tuneP best track
+    float trkPx, trkPy, trkPz;            // tracker track, 0 if none
+    float glbPx, glbPy, glbPz;            // global track, 0 if none
+    float trkEta, trkPhi, staEta, staPhi;
+    float glbPt, staPt;
+    float dxy, dz;                        // best track w.r.t. the first vertex
+    int charge, glbCharge;
+    bool hasTrk, hasSta, hasGlb, isLoose;
+    int cmbNDof, dtNDof, cscNDof, rpcNDof;
+    float cmbTime, cmbTimeErr, dtTime, dtTimeErr, cscTime, cscTimeErr, rpcTime, rpcTimeErr;
+    // ranges in the matches and rpcHits arrays of the event
+    unsigned int firstMatch, nMatches, firstRPCHit, nRPCHits;
+  };
+
+  struct Segment {
+    unsigned int chamber;
+    int detector;                         // MuonHitCounter::DT or CSC
+    float x, y;
+    int nHits;
+  };
+
+  struct RPCHit {
+    unsigned int roll;
+    float x;
+    int bx;
+  };
+
+  struct Candidate {
+    float pt, eta, phi;
+    int quality, bx;                      // L1: hardware quality; truth: pdgId
+  };
+
+  struct Vertex {
+    float x, y, z, ndof;
+  };
+
+  unsigned int run, lumi;
+  unsigned long long event;
+
+  std::vector<Muon> muons;
+  // muons x variables, in the order of the names in the file header
+  std::vector<float> variables;
+  std::vector<MuonHitCounter::ChamberMatch> matches;
+  std::vector<MuonHitCounter::TrackHit> rpcTrackHits;
+  std::vector<Segment> segments;
+  std::vector<RPCHit> rpcHits;
+  std::vector<Candidate> l1, genMuons, tpMuons;
+  std::vector<Vertex> vertices;
+
+  void clear();
+};
+
+
+class EventSnapshotWriter {
+public:
+  EventSnapshotWriter(const std::string& fileName, const std::vector<std::string>& variableNames);
+
+  void write(const EventSnapshot& event);
+  unsigned long long written() const { return theWritten; }
+  unsigned long long bytes() const { return theBytes; }
+
+private:
+  std::ofstream theFile;
+  unsigned int theNVariables;
+  unsigned long long theWritten, theBytes;
+  std::string theBuffer;
+};
+
+
+class EventSnapshotReader {
+public:
+  explicit EventSnapshotReader(const std::string& fileName);
+
+  const std::vector<std::string>& variableNames() const { return theVariableNames; }
+  /// next event, false at the end of the file
+  bool read(EventSnapshot& event);
+
+private:
+  std::ifstream theFile;
+  std::string theFileName;
+  std::vector<std::string> theVariableNames;
+  std::string theBuffer;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef UserCode_HSCPTOF_HardwareCounters_H
+#define UserCode_HSCPTOF_HardwareCounters_H
+
+/** \class HardwareCounters
+ *  CPU cycles, instructions, last level cache misses and branch misses of
+ *  the calling thread, from one perf_event_open group (user space only).
+ *
+ *  The counters count on the thread that opened them: open() again when
+ *  the caller moves to another thread. When the kernel refuses the
+ *  counters (no PMU in the VM, perf_event_paranoid, not Linux) the
+ *  software fallback is used: only the thread CPU time is measured, in ns,
+ *  in the cycles slot. A counter the CPU does not provide reads 0.
+ *  If the kernel multiplexes the group the values are scaled to the full
+ *  time.
+ */
+
+#include <thread>
+
+class HardwareCounters {
+public:
+  enum { cycles, instructions, llcMisses, branchMisses, nCounters };
+
+  HardwareCounters();
+  ~HardwareCounters();
+
+  /// (re)open the counters on the calling thread
+  void open();
+  void close();
+
+  /// false: software fallback, values[cycles] is the thread CPU time [ns]
+  bool hardware() const { return theLeader >= 0; }
+  bool available(int counter) const { return theIndex[counter] >= 0; }
+  std::thread::id thread() const { return theThread; }
+
+  void read(unsigned long long values[nCounters]) const;
+
+  static const char* name(int counter);
+
+private:
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  int theLeader;
+  int theFds[nCounters];
+  // position of each counter in the group read, -1 if not opened
+  int theIndex[nCounters];
+  int theNOpen;
+  std::thread::id theThread;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef UserCode_HSCPTOF_HistSnapshotWriter_H
+#define UserCode_HSCPTOF_HistSnapshotWriter_H
+
+/** \class HistSnapshotWriter
+ *  Periodic snapshots of the histograms of a long running job.
+ *
+ *  The histograms are copied on the event thread when a snapshot is due
+ *  (every N events and/or every N seconds) and written by a background thread
+ *  into a temporary file, which is then renamed to the snapshot file name.
+ *  A reader therefore always sees a complete file. If the previous snapshot
+ *  is still being written, the waiting copy is replaced by the newer one.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TObject;
+class TDirectory;
+
+class HistSnapshotWriter {
+public:
+  /// everyNEvents = 0 and everySeconds <= 0 disable the snapshots
+  HistSnapshotWriter(const std::string& fileName, unsigned int everyNEvents, double everySeconds);
+  ~HistSnapshotWriter();
+
+  bool enabled() const { return theEveryNEvents > 0 || theEverySeconds > 0; }
+
+  /// count an event, true if a snapshot is due
+  bool newEvent();
+
+  /// queue a snapshot; the writer takes ownership of the objects
+  void submit(std::vector<TObject*>& objects);
+
+  /// append directory-less copies of the histograms held by a directory
+  static void cloneHistograms(TDirectory* dir, std::vector<TObject*>& objects);
+
+  /// wait for the queued snapshot and stop the writing thread
+  void stop();
+
+  unsigned int written() const { return theWritten; }
+  unsigned int dropped() const { return theDropped; }
+
+private:
+  void run();
+  void write(std::vector<TObject*>& objects, unsigned long nEvents);
+
+  std::string theFileName;
+  unsigned int theEveryNEvents;
+  double theEverySeconds;
+
+  unsigned long theEvents;
+  unsigned long theLastEvents;
+  std::chrono::steady_clock::time_point theLastTime;
+
+  std::thread theThread;
+  std::mutex theMutex;
+  std::condition_variable theCondition;
+  std::vector<TObject*> thePending;
+  unsigned long thePendingEvents;
+  bool theHasPending;
+  bool theStop;
+
+  unsigned int theWritten;
+  unsigned int theDropped;
+};
+
+#endif
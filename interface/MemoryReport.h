@@ -0,0 +1,58 @@
+#ifndef UserCode_HSCPTOF_MemoryReport_H
+#define UserCode_HSCPTOF_MemoryReport_H
+
+/** \class MemoryReport
+ *  Memory footprint of a module: bytes per histogram group, TTree basket
+ *  buffers and the resident size and high-water mark of the process.
+ *
+ *  Histograms are grouped by the first word of their name after "hi_"
+ *  (hi_dttime_vtx -> dttime). Every entry has its current size and the
+ *  size it can grow to (e.g. a SparseHist2D with all its blocks filled),
+ *  so a report taken right after booking is a prediction of the peak.
+ *  The process numbers come from /proc/self/status and are 0 where it is
+ *  not available.
+ */
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+class TDirectory;
+class TH1;
+class TTree;
+
+class MemoryReport {
+public:
+  explicit MemoryReport(const std::string& name) : theName(name) {}
+
+  void clear() { theGroups.clear(); }
+  void add(const std::string& group, size_t bytes, size_t maxBytes);
+  void add(const std::string& group, size_t bytes) { add(group, bytes, bytes); }
+  /// all the histograms in the directory and its subdirectories
+  void addHistograms(TDirectory* dir);
+  void addHistogram(const TH1* h);
+  /// basket buffers of all the branches
+  void addTree(const TTree* tree);
+
+  /// total over the groups
+  size_t bytes() const;
+  size_t maxBytes() const;
+  void print(std::ostream& out, const std::string& when) const;
+
+  /// bin contents, sum of squared weights and variable bin edges
+  static size_t histogramBytes(const TH1* h);
+  /// resident set size and its high-water mark [kB]
+  static void processMemory(long& rssKB, long& peakKB);
+
+private:
+  struct Group {
+    unsigned int n;
+    size_t bytes, maxBytes;
+  };
+
+  std::string theName;
+  std::map<std::string, Group> theGroups;
+};
+
+#endif
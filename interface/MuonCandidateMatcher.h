@@ -0,0 +1,48 @@
+#ifndef UserCode_HSCPTOF_MuonCandidateMatcher_H
+#define UserCode_HSCPTOF_MuonCandidateMatcher_H
+
+/** \class MuonCandidateMatcher
+ *  Truth and L1 candidates of the event matched to a reconstructed muon in eta and phi.
+ *
+ *  The candidates are kept as separate eta/phi arrays, added once per event.
+ *  Truth: the first muon with |deta|<0.05 and |dphi|<0.05 w.r.t. the tracker
+ *  track or the standalone track of the muon.
+ *  L1: all the candidates with |dphi|<0.1 and |deta|<0.4, except those that
+ *  are closer in both eta and phi to one of the other muons of the event,
+ *  so that close-by muons do not share their L1 candidates.
+ *
+ *  Uses no framework types, so it can run outside cmsRun (bin/hscptofBench).
+ */
+
+#include <vector>
+
+class MuonCandidateMatcher {
+public:
+  /// muon direction used for the L1 cross-matching protection
+  struct Direction {
+    unsigned int index;
+    float eta, phi;
+  };
+
+  void clear();
+  /// index is returned by the matching
+  void add(unsigned int index, float eta, float phi);
+  unsigned int size() const { return theIndex.size(); }
+  unsigned int index(unsigned int i) const { return theIndex[i]; }
+
+  /// index of the first candidate matched to either direction, -1 if none; a direction is skipped if has is false
+  int matchTruth(bool hasTrk, float trkEta, float trkPhi, bool hasSta, float staEta, float staPhi) const;
+
+  /// indices of the candidates matched to the muon self at (eta, phi)
+  void matchL1(unsigned int self, float eta, float phi, const std::vector<Direction>& muons,
+               std::vector<unsigned int>& matches) const;
+
+  /// phi1-phi2 in [-pi, pi]
+  static float deltaPhi(float phi1, float phi2);
+
+private:
+  std::vector<unsigned int> theIndex;
+  std::vector<float> theEta, thePhi;
+};
+
+#endif
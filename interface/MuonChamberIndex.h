@@ -0,0 +1,87 @@
+#ifndef UserCode_HSCPTOF_MuonChamberIndex_H
+#define UserCode_HSCPTOF_MuonChamberIndex_H
+
+/** \namespace MuonChamberIndex
+ *  Dense numbering of the DT and CSC chambers and layers, for per-chamber arrays.
+ *
+ *  DT chambers: 5 wheels x 4 stations x 14 sectors, followed by the
+ *  CSC chambers: 2 endcaps x 4 stations x 4 rings (ring 4 = ME1/1a) x 36 chambers.
+ *  DT layers: 3 superlayers x 4 layers per chamber, followed by the
+ *  CSC layers: 6 per chamber. Not every slot is a real chamber.
+ */
+
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
+#include "DataFormats/MuonDetId/interface/DTLayerId.h"
+#include "DataFormats/MuonDetId/interface/CSCDetId.h"
+
+namespace MuonChamberIndex {
+
+  const int nDTChambers = 5 * 4 * 14;
+  const int nCSCChambers = 2 * 4 * 4 * 36;
+  const int nChambers = nDTChambers + nCSCChambers;
+
+  const int nDTLayers = nDTChambers * 12;
+  const int nCSCLayers = nCSCChambers * 6;
+  const int nLayers = nDTLayers + nCSCLayers;
+
+  inline int dt(int wheel, int station, int sector) {
+    return ((wheel + 2) * 4 + station - 1) * 14 + sector - 1;
+  }
+
+  inline int csc(int endcap, int station, int ring, int chamber) {
+    return nDTChambers + (((endcap - 1) * 4 + station - 1) * 4 + ring - 1) * 36 + chamber - 1;
+  }
+
+  /// chamber index of any DT or CSC DetId (chamber, superlayer or layer level), -1 otherwise
+  inline int chamber(DetId id) {
+    if (id.det() != DetId::Muon) return -1;
+    if (id.subdetId() == MuonSubdetId::DT) {
+      DTChamberId dtId(id.rawId());
+      return dt(dtId.wheel(), dtId.station(), dtId.sector());
+    }
+    if (id.subdetId() == MuonSubdetId::CSC) {
+      CSCDetId cscId(id.rawId());
+      return csc(cscId.endcap(), cscId.station(), cscId.ring(), cscId.chamber());
+    }
+    return -1;
+  }
+
+  /// layer index of a DT or CSC layer DetId, -1 otherwise
+  inline int layer(DetId id) {
+    if (id.det() != DetId::Muon) return -1;
+    if (id.subdetId() == MuonSubdetId::DT) {
+      DTLayerId dtId(id.rawId());
+      if (!dtId.superlayer() || !dtId.layer()) return -1;
+      return dt(dtId.wheel(), dtId.station(), dtId.sector()) * 12 + (dtId.superlayer() - 1) * 4 + dtId.layer() - 1;
+    }
+    if (id.subdetId() == MuonSubdetId::CSC) {
+      CSCDetId cscId(id.rawId());
+      if (!cscId.layer()) return -1;
+      return nDTLayers + (csc(cscId.endcap(), cscId.station(), cscId.ring(), cscId.chamber()) - nDTChambers) * 6
+             + cscId.layer() - 1;
+    }
+    return -1;
+  }
+
+  inline bool isDT(int chamberIndex) { return chamberIndex >= 0 && chamberIndex < nDTChambers; }
+  inline bool isCSC(int chamberIndex) { return chamberIndex >= nDTChambers && chamberIndex < nChambers; }
+
+  /// inverse of dt() / csc(): wheel, station, sector (chamber = 0) or endcap, station, ring, chamber
+  inline void decode(int chamberIndex, int& first, int& station, int& third, int& chamber) {
+    if (isDT(chamberIndex)) {
+      first = chamberIndex / (4 * 14) - 2;
+      station = chamberIndex / 14 % 4 + 1;
+      third = chamberIndex % 14 + 1;
+      chamber = 0;
+    } else {
+      int i = chamberIndex - nDTChambers;
+      first = i / (4 * 4 * 36) + 1;
+      station = i / (4 * 36) % 4 + 1;
+      third = i / 36 % 4 + 1;
+      chamber = i % 36 + 1;
+    }
+  }
+}
+
+#endif
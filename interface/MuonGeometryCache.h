@@ -0,0 +1,64 @@
+#ifndef UserCode_HSCPTOF_MuonGeometryCache_H
+#define UserCode_HSCPTOF_MuonGeometryCache_H
+
+/** \class MuonGeometryCache
+ *  Local-to-global transforms of all DT and CSC chambers and layers in dense tables.
+ *
+ *  The tables are indexed with MuonChamberIndex and rebuilt only when the
+ *  MuonGeometryRecord IOV changes, so that the global position of a segment
+ *  or hit is a table lookup and a 3x3 product instead of a geometry search.
+ */
+
+#include "FWCore/Framework/interface/ESWatcher.h"
+#include "Geometry/Records/interface/MuonGeometryRecord.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/GeometryVector/interface/GlobalPoint.h"
+#include "UserCode/HSCPTOF/interface/MuonChamberIndex.h"
+
+#include <vector>
+
+namespace edm {
+  class EventSetup;
+}
+class GeomDet;
+
+struct MuonDetTransform {
+  float pos[3];                 // origin of the local frame, global coordinates
+  float ex[3], ey[3], ez[3];    // local axes, global coordinates
+  float dist;                   // distance of the origin from (0,0,0)
+  bool valid;
+};
+
+class MuonGeometryCache {
+public:
+  MuonGeometryCache();
+
+  /// rebuild the tables if the geometry changed; true if they were rebuilt
+  bool update(const edm::EventSetup& iSetup);
+
+  /// transforms by dense index, check valid before use
+  const MuonDetTransform& chamber(int index) const { return theChambers[index]; }
+  const MuonDetTransform& layer(int index) const { return theLayers[index]; }
+
+  /// transforms by DetId, 0 for unknown ids
+  const MuonDetTransform* chamber(DetId id) const;
+  const MuonDetTransform* layer(DetId id) const;
+
+  static GlobalPoint toGlobal(const MuonDetTransform& t, float x, float y, float z = 0.) {
+    return GlobalPoint(t.pos[0] + t.ex[0] * x + t.ey[0] * y + t.ez[0] * z,
+                       t.pos[1] + t.ex[1] * x + t.ey[1] * y + t.ez[1] * z,
+                       t.pos[2] + t.ex[2] * x + t.ey[2] * y + t.ez[2] * z);
+  }
+
+  unsigned int nBuilds() const { return theNBuilds; }
+
+private:
+  static void fill(MuonDetTransform& t, const GeomDet& det);
+
+  edm::ESWatcher<MuonGeometryRecord> theWatcher;
+  std::vector<MuonDetTransform> theChambers;
+  std::vector<MuonDetTransform> theLayers;
+  unsigned int theNBuilds;
+};
+
+#endif
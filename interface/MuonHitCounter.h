@@ -0,0 +1,90 @@
+#ifndef UserCode_HSCPTOF_MuonHitCounter_H
+#define UserCode_HSCPTOF_MuonHitCounter_H
+
+/** \class MuonHitCounter
+ *  Segments and hits of the event near a muon, per station.
+ *
+ *  The DT/CSC segments, RPC hits and DT/CSC rechits of the event are copied
+ *  once into flat arrays sorted by DetId (chamber for the segments, roll
+ *  for RPC, layer for the rechits), so the objects in a given detector are
+ *  found by binary search instead of a loop over the whole collection for
+ *  every muon. Stations are 1-4, out-of-range stations are ignored.
+ *
+ *  DT segments: within 25 cm of the chamber match in local x or in local y,
+ *  counting the distinct x and the distinct y positions (0.1 cm) and taking
+ *  the larger number. CSC segments: within 25 cm of the match in local
+ *  (x,y), distinct if no kept segment is within 2e-4 in phi or none is
+ *  within 2 in the number of hits. In both the best matched segment of the
+ *  chamber is not counted.
+ *  RPC hits: in-time (BX 0) hits within 30 cm in local x of a muon RPC hit
+ *  in the same roll, per layer; stations 1 and 2 take the larger layer.
+ *  Rechits: the largest number of rechits within 20 cm of a muon DT/CSC
+ *  hit in the same layer (x distance for DT, 2D distance for CSC).
+ *
+ *  Uses no framework types, so it can run outside cmsRun (bin/hscptofBench).
+ */
+
+#include <vector>
+
+class MuonHitCounter {
+public:
+  // same values as MuonSubdetId
+  enum Detector { DT = 1, CSC = 2, RPC = 3 };
+  // the lists of objects
+  enum Kind { DTSegments, CSCSegments, RPCHits, DTRecHits, CSCRecHits, NKinds };
+
+  /// chamber crossed by the muon (reco::MuonChamberMatch)
+  struct ChamberMatch {
+    unsigned int chamber;      // DetId raw id of the chamber
+    int detector;
+    int station;
+    float x, y;                // local position of the extrapolated muon
+    bool hasBestSegment;       // a segment is matched with BestInChamberByDR
+  };
+
+  /// muon hit of the track
+  struct TrackHit {
+    unsigned int detId;        // RPC roll, DT or CSC layer
+    int detector;
+    int station, layer;
+    float x, y;                // local position
+  };
+
+  void clear();
+  /// chamber: DT chamber / CSC chamber raw id of the segment
+  void addDTSegment(unsigned int chamber, float x, float y);
+  void addCSCSegment(unsigned int chamber, float x, float y, int nHits);
+  void addRPCHit(unsigned int roll, float x, int bx);
+  /// layer: DT layer / CSC layer raw id of the rechit
+  void addDTRecHit(unsigned int layer, float x);
+  void addCSCRecHit(unsigned int layer, float x, float y);
+  /// sort the objects added since the last clear(), before the counting
+  void build();
+
+  /// extra DT and CSC segments in the chambers of the matches, added to stations[0..3]
+  void countDTSegments(const std::vector<ChamberMatch>& matches, int stations[4]) const;
+  void countCSCSegments(const std::vector<ChamberMatch>& matches, int stations[4]) const;
+  /// in-time RPC hits near the RPC hits of the track, stations[0..3] are set
+  void countRPCHits(const std::vector<TrackHit>& hits, int stations[4]) const;
+  /// largest number of rechits near a DT/CSC hit of the track, stations[0..3] are set
+  void countRecHits(const std::vector<TrackHit>& hits, int stations[4]) const;
+
+  /// number of objects added of each kind
+  unsigned int size(int kind) const { return theItems[kind].size(); }
+
+private:
+  struct Item {
+    unsigned int id;
+    float x, y;
+    int n;                     // CSC segment hits, RPC BX
+  };
+  typedef std::vector<Item>::const_iterator Iterator;
+
+  void add(int kind, unsigned int id, float x, float y, int n);
+  /// objects of the list with the given DetId
+  void range(int kind, unsigned int id, Iterator& begin, Iterator& end) const;
+
+  std::vector<Item> theItems[NKinds];
+};
+
+#endif
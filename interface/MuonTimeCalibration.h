@@ -0,0 +1,54 @@
+#ifndef UserCode_HSCPTOF_MuonTimeCalibration_H
+#define UserCode_HSCPTOF_MuonTimeCalibration_H
+
+/** \class MuonTimeCalibration
+ *  Per-chamber DT/CSC time offsets from a local text file, by run range.
+ *
+ *  The file is read once in the constructor; update(run) switches to the
+ *  offsets of the IOV containing the run only when the run leaves the
+ *  current IOV, and offset() is an array lookup by MuonChamberIndex.
+ *  Corrected time = segment time - offset.
+ *  File format, one entry per line, '#' starts a comment:
+ *    iov <first run>                           offsets below valid from this run to the next iov
+ *    DT <wheel> <station> <sector> <offset ns>
+ *    CSC <endcap> <station> <ring> <chamber> <offset ns>
+ *  Chambers not listed in an IOV have offset 0, runs before the first IOV too.
+ *  An empty file name gives a calibration with all offsets 0.
+ */
+
+#include <string>
+#include <vector>
+
+class MuonTimeCalibration {
+public:
+  explicit MuonTimeCalibration(const std::string& fileName = "");
+
+  /// select the IOV of the run; true if the offsets changed
+  bool update(unsigned int run);
+
+  /// offset [ns] of a chamber by dense index, 0 for -1
+  float offset(int chamberIndex) const { return chamberIndex < 0 ? 0.f : theOffsets[chamberIndex]; }
+
+  bool enabled() const { return !theIOVs.empty(); }
+  unsigned int nIOVs() const { return theIOVs.size(); }
+  /// chambers with an offset in the current IOV
+  unsigned int nChambers() const { return theNCurrent; }
+
+private:
+  struct Entry {
+    int chamber;
+    float offset;
+  };
+  struct IOV {
+    unsigned int firstRun;
+    std::vector<Entry> entries;
+  };
+
+  std::vector<IOV> theIOVs;
+  // runs [theFirstRun, theLastRun] use the current offsets
+  unsigned int theFirstRun, theLastRun;
+  std::vector<float> theOffsets;
+  unsigned int theNCurrent;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef UserCode_HSCPTOF_MuonTimingCuts_H
+#define UserCode_HSCPTOF_MuonTimingCuts_H
+
+/** \class MuonTimingCuts
+ *  Muon-level selection shared by the timing analyzers and the preselection filter.
+ *
+ *  PtCut and |eta| window, plus requireId: either one of the predefined
+ *  names ("glb", "loose", "tight", "norpc", "norpc3", "timeok", "" for no
+ *  cut) or a SelectionExpression over the muon variables listed in
+ *  variableNames(), e.g. "isLoose && rpcNdof<=1 && abs(dtTime)<20".
+ *  The expression is compiled once in the constructor and only the
+ *  variables it uses are computed for each muon. A module that cannot fill
+ *  all the variables (no DT/CSC time maps) gives the list of those it has,
+ *  and an expression using another one is a configuration error.
+ *  Without a vertex isTight is the tight ID without its impact parameter
+ *  cuts, so the selection is a superset of the one with a vertex.
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "UserCode/HSCPTOF/interface/SelectionExpression.h"
+
+#include <string>
+#include <vector>
+
+class MuonTimingCuts {
+public:
+  /// timing inputs of the selection for one muon
+  struct MuonTimeInfo {
+    reco::MuonTime rpc;                  // nDof set to 0 outside the -60..80 ns window
+    int cmbNDof, dtNDof, cscNDof;
+    float cmbTime, cmbTimeErr, dtTime, dtTimeErr, cscTime, cscTimeErr;
+    bool timeOk;                         // see timeOk()
+  };
+
+  /// throws cms::Exception if idCut uses a variable that is not in available
+  MuonTimingCuts(double ptCut, double etaMin, double etaMax, const std::string& idCut,
+                 const std::vector<std::string>& available = variableNames());
+
+  /// the compiled requireId expression
+  const std::string& selection() const { return theSelection.expression(); }
+  /// names of the variables of the requireId expressions
+  static const std::vector<std::string>& variableNames();
+  /// the variables filled by timeInfo(mu), i.e. all but the DT and CSC times
+  static const std::vector<std::string>& embeddedTimeVariables();
+
+  /// RPC time of the muon, with nDof set to 0 outside the -60..80 ns window
+  static reco::MuonTime rpcTime(const reco::Muon& mu);
+
+  /// time compatible with a prompt muon: |t_RPC|<20 ns if the RPC time is precise,
+  /// otherwise -50 < t < 20 ns for a combined time with nDof>4
+  static bool timeOk(const reco::MuonTime& rpc, int cmbNDof, double cmbTime);
+
+  /// combined time from Muon::time() (embedded by the muon producer); the DT/CSC times
+  /// are not available and set to 0, see embeddedTimeVariables()
+  static MuonTimeInfo timeInfo(const reco::Muon& mu);
+  /// combined, DT and CSC times from the MuonTimeExtra maps
+  static MuonTimeInfo timeInfo(const reco::Muon& mu, const reco::MuonTimeExtra& cmb,
+                               const reco::MuonTimeExtra& dt, const reco::MuonTimeExtra& csc);
+
+  bool passKinematics(const reco::Muon& mu) const;
+  /// requireId; vtx may be 0
+  bool passId(const reco::Muon& mu, const MuonTimeInfo& times, const reco::Vertex* vtx) const;
+
+  /// value of variable i of variableNames(); vtx may be 0
+  static double variable(unsigned int i, const reco::Muon& mu, const MuonTimeInfo& times, const reco::Vertex* vtx);
+
+private:
+
+  double thePtCut;
+  double theMinEta, theMaxEta;
+  SelectionExpression theSelection;
+  std::vector<unsigned int> theUsedVariables;
+};
+
+#endif
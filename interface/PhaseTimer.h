@@ -0,0 +1,106 @@
+#ifndef UserCode_HSCPTOF_PhaseTimer_H
+#define UserCode_HSCPTOF_PhaseTimer_H
+
+/** \class PhaseTimer
+ *  Wall-clock time spent per event in each phase of an analyze() method.
+ *
+ *  mark(phase) charges the time since the previous mark (or since
+ *  startEvent) to the phase, so a phase may be marked several times per
+ *  event, e.g. once per muon. An event is closed by the next startEvent()
+ *  or by finish(), so early returns from analyze() need no extra call.
+ *  The per-event phase times are accumulated in latency histograms with
+ *  10 logarithmic bins per decade from 100 ns to 100 s, and the slowest
+ *  events are kept with their sizes (muons, TrackingParticles, segments)
+ *  and phase breakdown. A disabled timer does not read the clock.
+ *
+ *  With counters, every mark also reads the HardwareCounters of the thread
+ *  (cycles, instructions, LLC and branch misses, or the thread CPU time
+ *  when the kernel does not give access to them), summed per phase.
+ */
+
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TH1F;
+class HardwareCounters;
+
+class PhaseTimer {
+public:
+  PhaseTimer(const std::string& name, const std::vector<std::string>& phases, bool enabled, unsigned int nSlowest,
+             bool counters = false);
+  ~PhaseTimer();
+
+  bool enabled() const { return theEnabled; }
+  unsigned int size() const { return thePhases.size(); }
+
+  /// close the previous event and start timing a new one
+  void startEvent(unsigned int run, unsigned int lumi, unsigned long long event);
+  /// charge the time since the previous mark to the phase
+  void mark(unsigned int phase) {
+    if (!theEnabled) return;
+    Clock::time_point now = Clock::now();
+    theCurrent[phase] += std::chrono::duration<double>(now - theLast).count();
+    theLast = now;
+    if (theCounters) count(phase);
+  }
+  /// sizes of the current event, for the slow event log
+  void setSizes(unsigned int nMuons, unsigned int nTP, unsigned int nSegments);
+  /// close the last event
+  void finish();
+
+  unsigned long long events() const { return theEvents; }
+  /// total time of a phase, summed over the events [s]
+  double total(unsigned int phase) const { return theTotals[phase]; }
+
+  /// latency histogram of a phase (phase == size(): whole event), not attached to a
+  /// directory; the caller writes and deletes it
+  TH1F* histogram(unsigned int phase) const;
+  /// mean, median, 99% quantile and maximum per phase, then the slowest events
+  void print(std::ostream& out) const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct EventRecord {
+    unsigned int run, lumi;
+    unsigned long long event;
+    unsigned int nMuons, nTP, nSegments;
+    double total;
+    std::vector<double> phases;
+  };
+
+  static const int theBinsPerDecade = 10;
+  static const int theMinDecade = -7;
+  static const int theMaxDecade = 2;
+
+  static int bin(double seconds);
+  double quantile(const std::vector<unsigned long long>& counts, double q) const;
+  void count(unsigned int phase);
+  void printCounters(std::ostream& out) const;
+
+  std::string theName;
+  std::vector<std::string> thePhases;
+  bool theEnabled;
+  unsigned int theNSlowest;
+
+  bool theOpen;
+  Clock::time_point theLast;
+  EventRecord theEvent;
+  std::vector<double> theCurrent;
+
+  unsigned long long theEvents;
+  std::vector<double> theTotals, theMax;
+  // [phase][bin], phase size() is the whole event; bin 0 and the last bin are under/overflow
+  std::vector<std::vector<unsigned long long> > theCounts;
+  // min-heap on the total time
+  std::vector<EventRecord> theSlowest;
+
+  std::unique_ptr<HardwareCounters> theCounters;
+  // [phase * nCounters + counter], at the last mark, in the current event and summed over the events
+  std::vector<unsigned long long> theLastCount, theCurrentCounts, theTotalCounts;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef UserCode_HSCPTOF_QuantileSketch_H
+#define UserCode_HSCPTOF_QuantileSketch_H
+
+/** \class QuantileSketch
+ *  Mergeable streaming quantile estimate (KLL sketch) in a few kB.
+ *
+ *  Items go to level 0; a full level is sorted and every other item (random
+ *  offset) moves up one level with twice the weight; of an odd number of items
+ *  the smallest or the largest (random) stays behind. Level h holds about
+ *  k*(2/3)^(H-1-h) items, H levels, so the sketch keeps at most ~3k items whatever
+ *  the number of entries, and the rank error of quantile() is ~1.7/k.
+ *  Sketches with the same k merge level by level, e.g. across streams or
+ *  jobs. The coin of the compactions is a fixed sequence, so the same
+ *  inputs in the same order give the same sketch.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class QuantileSketch {
+public:
+  explicit QuantileSketch(unsigned int k = 200);
+  /// rebuilt from serialize()
+  QuantileSketch(unsigned int k, unsigned long long n, const std::vector<float>& items,
+                 const std::vector<unsigned int>& levelSizes);
+
+  void add(float x) {
+    theLevels[0].push_back(x);
+    theN++;
+    if (++theSize >= theCapacity) compress();
+  }
+  /// throws std::invalid_argument if the k differ
+  void merge(const QuantileSketch& other);
+
+  /// value below which a fraction q of the entries lie, 0 if empty
+  float quantile(double q) const;
+
+  unsigned int k() const { return theK; }
+  unsigned long long count() const { return theN; }
+  /// items kept
+  unsigned int size() const { return theSize; }
+  size_t bytes() const;
+
+  /// items of all levels, lowest level first, and the number of items per level
+  void serialize(std::vector<float>& items, std::vector<unsigned int>& levelSizes) const;
+
+private:
+  unsigned int capacity(unsigned int level) const;
+  void updateCapacity();
+  void compress();
+
+  unsigned int theK;
+  unsigned long long theN;
+  std::vector<std::vector<float> > theLevels;
+  unsigned int theSize, theCapacity;
+  uint32_t theRandom;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef UserCode_HSCPTOF_SelectionExpression_H
+#define UserCode_HSCPTOF_SelectionExpression_H
+
+/** \class SelectionExpression
+ *  Cut string compiled once into a flat postfix program over numbered variables.
+ *
+ *  Grammar (C precedence, loosest first): || && (== !=) (< <= > >=) (+ -)
+ *  (* /) (unary - !), parentheses, numbers, variable names and abs(x);
+ *  binary operators associate to the left. A value is true if it
+ *  is non-zero. The variable names are given to the constructor; the
+ *  program refers to them by index, and used(i) tells which of them have
+ *  to be filled before evaluation. An empty string always passes.
+ *  Syntax errors and unknown names throw std::invalid_argument.
+ */
+
+#include <string>
+#include <vector>
+
+class SelectionExpression {
+public:
+  SelectionExpression(const std::string& expression, const std::vector<std::string>& variables);
+
+  const std::string& expression() const { return theExpression; }
+  bool empty() const { return theProgram.empty(); }
+  /// true if the program reads variable i
+  bool used(unsigned int i) const { return theUsed[i]; }
+
+  /// vars[i] is the value of variable i; only the used ones are read
+  bool operator()(const double* vars) const { return theProgram.empty() || evaluate(vars) != 0.; }
+  double evaluate(const double* vars) const;
+
+private:
+  enum OpCode { Const, Var, Neg, Not, Abs, Add, Sub, Mul, Div, Lt, Le, Gt, Ge, Eq, Ne, And, Or };
+  struct Op {
+    OpCode code;
+    double value;         // Const: the number, Var: the variable index
+  };
+  static const unsigned int theMaxDepth = 32;
+
+  class Parser;
+
+  std::string theExpression;
+  std::vector<Op> theProgram;
+  std::vector<bool> theUsed;
+};
+
+#endif
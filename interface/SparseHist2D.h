@@ -0,0 +1,91 @@
+#ifndef UserCode_HSCPTOF_SparseHist2D_H
+#define UserCode_HSCPTOF_SparseHist2D_H
+
+/** \class SparseHist2D
+ *  Block-sparse replacement for large, mostly empty TH2F histograms.
+ *
+ *  The bin grid (including under/overflow, with the same bin numbering as ROOT)
+ *  is split in blocks of 16x16 bins which are allocated on the first fill.
+ *  The statistics are accumulated as in TH2::Fill, so the TH2F produced at
+ *  write time is identical to the one filled directly.
+ */
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TH2F;
+class THnSparseF;
+
+class SparseHist2D {
+public:
+  SparseHist2D(const char* name, const char* title,
+               int nbinsx, double xlow, double xup,
+               int nbinsy, double ylow, double yup);
+
+  void Fill(double x, double y, double w = 1.);
+  void Reset();
+
+  /// convert to a TH2F / THnSparseF not attached to any directory (caller owns it)
+  TH2F* toTH2F() const;
+  THnSparseF* toTHnSparse() const;
+
+  /// convert and write into the current directory
+  void Write(bool asTHnSparse = false) const;
+
+  const std::string& name() const { return theName; }
+  double entries() const { return theEntries; }
+
+  /// memory of the equivalent TH2F bin array and of this object
+  size_t denseBytes() const;
+  size_t sparseBytes() const;
+  unsigned int allocatedBlocks() const { return theNAllocated; }
+
+private:
+  static const int theBlockBits = 4;
+  static const int theBlockSize = 1 << theBlockBits;
+
+  int findBin(double v, int nbins, double low, double up) const;
+
+  std::string theName, theTitle;
+  int theNx, theNy;
+  double theXlow, theXup, theYlow, theYup;
+  int theNBlocksX, theNBlocksY;
+
+  std::vector<std::unique_ptr<float[]> > theBlocks;
+  unsigned int theNAllocated;
+
+  double theEntries;
+  double theTsumw, theTsumw2, theTsumwx, theTsumwx2, theTsumwy, theTsumwy2, theTsumwxy;
+};
+
+inline int SparseHist2D::findBin(double v, int nbins, double low, double up) const {
+  if (v < low) return 0;
+  if (!(v < up)) return nbins + 1;
+  return 1 + int(nbins * (v - low) / (up - low));
+}
+
+inline void SparseHist2D::Fill(double x, double y, double w) {
+  int ix = findBin(x, theNx, theXlow, theXup);
+  int iy = findBin(y, theNy, theYlow, theYup);
+
+  std::unique_ptr<float[]>& block = theBlocks[(iy >> theBlockBits) * theNBlocksX + (ix >> theBlockBits)];
+  if (!block) {
+    block.reset(new float[theBlockSize * theBlockSize]());
+    theNAllocated++;
+  }
+  block[((iy & (theBlockSize - 1)) << theBlockBits) + (ix & (theBlockSize - 1))] += w;
+
+  theEntries++;
+  if (ix == 0 || ix > theNx || iy == 0 || iy > theNy) return;
+  theTsumw += w;
+  theTsumw2 += w * w;
+  theTsumwx += w * x;
+  theTsumwx2 += w * x * x;
+  theTsumwy += w * y;
+  theTsumwy2 += w * y * y;
+  theTsumwxy += w * x * y;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef UserCode_HSCPTOF_TimingCellStats_H
+#define UserCode_HSCPTOF_TimingCellStats_H
+
+/** \class TimingCellStats
+ *  Streaming time statistics per cell (chamber, eta/phi bin...): Welford
+ *  moments and a KLL quantile sketch, without booking histograms.
+ *
+ *  Cells are dense indices; the table grows when a larger cell is filled
+ *  or read back. table() writes one TTree row per filled cell with the
+ *  summary (n, mean, RMS, 16/50/84% quantiles) and the full state (Welford
+ *  sums and sketch items), and addTable() merges such rows back in, so
+ *  the tables of several streams or jobs (also concatenated by
+ *  hscptofMerge) combine into the same result as a single job.
+ */
+
+#include "UserCode/HSCPTOF/interface/QuantileSketch.h"
+#include "UserCode/HSCPTOF/interface/TimingStats.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class TTree;
+
+class TimingCellStats {
+public:
+  /// k = 0: the k of the first table read by addTable(), for statistics that are only read back
+  TimingCellStats(unsigned int nCells, unsigned int k);
+
+  /// cell < 0 is ignored
+  void fill(int cell, float time) {
+    if (cell < 0) return;
+    if ((unsigned int)cell >= theMoments.size()) resize(cell + 1);
+    theMoments[cell].add(time);
+    theSketches[cell].add(time);
+  }
+  /// throws std::invalid_argument if the k differ
+  void merge(const TimingCellStats& other);
+
+  unsigned int size() const { return theMoments.size(); }
+  const TimingMoments& moments(int cell) const { return theMoments[cell]; }
+  const QuantileSketch& sketch(int cell) const { return theSketches[cell]; }
+  size_t bytes() const;
+
+  /// summary and state of the filled cells, label(cell) in the "label" column (the labels read by
+  /// addTable() if no function is given); the caller owns the tree
+  TTree* table(const char* name, const char* title,
+               const std::function<std::string(int)>& label = std::function<std::string(int)>()) const;
+  /// merge the rows of a table() tree; false if it has not the expected columns, throws
+  /// std::invalid_argument (nothing merged) if a row was written with another k
+  bool addTable(TTree* tree);
+  /// label of a cell read by addTable(), empty if none
+  std::string label(int cell) const { return (unsigned int)cell < theLabels.size() ? theLabels[cell] : std::string(); }
+
+private:
+  void resize(unsigned int nCells);
+
+  unsigned int theK;
+  std::vector<TimingMoments> theMoments;
+  std::vector<QuantileSketch> theSketches;
+  std::vector<std::string> theLabels;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef UserCode_HSCPTOF_TimingCutScan_H
+#define UserCode_HSCPTOF_TimingCutScan_H
+
+/** \class TimingCutScan
+ *  Number of muons rejected by a |time| > i cut, for i = 0..nCuts-1, with at
+ *  least j+1 degrees of freedom, for j = 0..nDofCuts-1.
+ *
+ *  A muon with time t and nDof is rejected by all the cuts (i, j) with
+ *  i < |t| and j < nDof, a rectangle starting at (0, 0): fill() only counts
+ *  the corner (ceil|t|, nDof) of the rectangle and count() adds up the
+ *  corners above (i, j), so a muon costs one increment instead of
+ *  nCuts x nDofCuts histogram fills. A scan without nDof condition has
+ *  nDofCuts = 1 and is filled with nDof 1 (pass) or 0 (no time).
+ */
+
+#include <vector>
+
+class TimingCutScan {
+public:
+  TimingCutScan(unsigned int nCuts = 50, unsigned int nDofCuts = 15);
+
+  void fill(float time, int nDof);
+
+  unsigned int nCuts() const { return theNCuts; }
+  unsigned int nDofCuts() const { return theNDofCuts; }
+  /// muons rejected by the cut |time| > i with nDof > j
+  unsigned long long count(unsigned int i, unsigned int j = 0) const;
+  /// number of (i, j) cuts rejecting a muon, summed over the muons (histogram entries of the fill loop)
+  unsigned long long entries() const;
+
+  /// add the counts of another scan with the same cuts
+  void merge(const TimingCutScan& other);
+
+private:
+  unsigned int theNCuts, theNDofCuts;
+  // muons per corner (ceil|t|, nDof), both clipped to the number of cuts
+  std::vector<unsigned long long> theCorners;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef UserCode_HSCPTOF_TimingStats_H
+#define UserCode_HSCPTOF_TimingStats_H
+
+/** \class TimingMoments
+ *  Running count, mean and RMS (Welford's algorithm), mergeable.
+ *
+ *  \class TimingSummary
+ *  Compact time-at-vertex summary of the DT, CSC, RPC and combined
+ *  measurements (moments and a coarse histogram), e.g. for one lumi section.
+ */
+
+#include <cmath>
+
+struct TimingMoments {
+  TimingMoments() : n(0), mean(0), m2(0) {}
+
+  void add(double x) {
+    n++;
+    double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+  }
+
+  void merge(const TimingMoments& other) {
+    if (!other.n) return;
+    if (!n) {
+      *this = other;
+      return;
+    }
+    double total = n + other.n;
+    double delta = other.mean - mean;
+    mean += delta * other.n / total;
+    m2 += other.m2 + delta * delta * n * other.n / total;
+    n += other.n;
+  }
+
+  double rms() const { return n > 1 ? std::sqrt(m2 / n) : 0.; }
+
+  unsigned long n;
+  double mean;
+  double m2;
+};
+
+class TimingSummary {
+public:
+  enum System { DT = 0, CSC, RPC, CMB, NSystems };
+
+  // coarse histogram: 5 ns bins, plus underflow (0) and overflow (nBins+1)
+  static const int nBins = 40;
+  static constexpr double tMin = -75.;
+  static constexpr double tMax = 125.;
+
+  TimingSummary() : nEvents(0) {
+    for (int is = 0; is < NSystems; is++)
+      for (int ib = 0; ib < nBins + 2; ib++) hist[is][ib] = 0;
+  }
+
+  void fill(System system, double t) {
+    moments[system].add(t);
+    int bin = (t < tMin) ? 0 : (t >= tMax) ? nBins + 1 : 1 + int(nBins * (t - tMin) / (tMax - tMin));
+    hist[system][bin]++;
+  }
+
+  void merge(const TimingSummary& other) {
+    nEvents += other.nEvents;
+    for (int is = 0; is < NSystems; is++) {
+      moments[is].merge(other.moments[is]);
+      for (int ib = 0; ib < nBins + 2; ib++) hist[is][ib] += other.hist[is][ib];
+    }
+  }
+
+  static const char* name(int system) {
+    static const char* names[NSystems] = {"dt", "csc", "rpc", "cmb"};
+    return names[system];
+  }
+
+  unsigned int nEvents;
+  TimingMoments moments[NSystems];
+  unsigned int hist[NSystems][nBins + 2];
+};
+
+#endif
@@ -96,7 +96,10 @@ AodNtupleFiller::AodNtupleFiller(const edm::ParameterSet& iConfig)
   theDebug(iConfig.getParameter<bool>("debug")),
   doSim(iConfig.getParameter<bool>("mctruthMatching")),
   theAngleCut(iConfig.getParameter<double>("angleCut")),
-  thePtCut(iConfig.getParameter<double>("PtCut"))
+  theCosmicTagger(theAngleCut),
+  thePtCut(iConfig.getParameter<double>("PtCut")),
+  theEventFlow("eventCutFlow", {"all","beam spot","has muons"}),
+  theMuonFlow("muonCutFlow", {"all","pt"})
 {
   edm::ConsumesCollector collector(consumesCollector());
   beamSpotToken_ = consumes<reco::BeamSpot>(edm::InputTag("offlineBeamSpot"));
@@ -137,6 +140,7 @@ AodNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup
 
   if (debug)
     cout << endl << " Event: " << iEvent.id() << "  Orbit: " << iEvent.orbitNumber() << "  BX: " << iEvent.bunchCrossing() << endl;
+  theEventFlow.pass(evAll);
 
   reco::Vertex::Point posVtx;
   reco::Vertex::Error errVtx;
@@ -162,6 +166,7 @@ AodNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup
       cout << "No beam spot available from EventSetup." << endl;
       return;
     }
+  theEventFlow.pass(evBeamSpot);
   math::XYZPoint beamspot(beamSpot.x0(),beamSpot.y0(), beamSpot.z0());
 
   const reco::Vertex pvertex(posVtx,errVtx);
@@ -189,23 +194,15 @@ AodNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup
   const pat::MuonCollection muonC = *(MuCollection.product());
   if (debug) cout << " Muon collection size: " << muonC.size() << endl;
   if (!muonC.size()) return;
-  MuonCollection::const_iterator imuon,iimuon;
+  theEventFlow.pass(evMuons);
+  MuonCollection::const_iterator imuon;
 
   // check for back-to-back dimuons
-  float angle=0;
-  isCosmic=0;
-  if (muonC.size()>1) {
-    for(imuon = muonC.begin(); imuon != muonC.end(); ++imuon) {
-      if ((imuon->isGlobalMuon() || imuon->isTrackerMuon()) && (imuon->track().isNonnull())) {
-        for(iimuon = imuon+1; iimuon != muonC.end(); ++iimuon) 
-          if ((iimuon->isGlobalMuon() || iimuon->isTrackerMuon()) && (iimuon->track().isNonnull())) {
-            double cross = imuon->track()->momentum().Dot(iimuon->track()->momentum());
-            angle = acos(-cross/iimuon->track()->p()/imuon->track()->p());
-            if (angle<theAngleCut) isCosmic=1;
-          }
-      }        
-    }    
-  } 
+  theCosmicTagger.clear();
+  for(imuon = muonC.begin(); imuon != muonC.end(); ++imuon)
+    if ((imuon->isGlobalMuon() || imuon->isTrackerMuon()) && (imuon->track().isNonnull()))
+      theCosmicTagger.add(imuon-muonC.begin(), imuon->track()->px(), imuon->track()->py(), imuon->track()->pz());
+  isCosmic = !theCosmicTagger.tag().empty();
 
   int imucount=0;
   for(imuon = muonC.begin(); imuon != muonC.end(); ++imuon){
@@ -218,11 +215,13 @@ AodNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup
 
     pat::MuonRef muonR(MuCollection,imucount);
     imucount++;    
+    theMuonFlow.pass(muAll);
     
     reco::MuonTime timerpc = imuon->rpcTime();
     reco::MuonTime timemuon = imuon->time();
         
     if (imuon->pt()<thePtCut) continue;
+    theMuonFlow.pass(muPt);
     if (debug) cout << endl << "   Found muon. Pt: " << imuon->pt() << endl;
 
     hasSim = 0;
@@ -341,8 +340,20 @@ AodNtupleFiller::endJob() {
 
   hFile->cd();
   t->Write();
+  hFile->mkdir("cutflow");
+  hFile->cd("cutflow");
+  for (const CutFlow* flow : {&theEventFlow, &theMuonFlow}) {
+    TH1F* h = flow->histogram();
+    h->Write();
+    delete h;
+  }
+  hFile->cd();
   hFile->Write();
   delete t;  
+
+  cout << endl;
+  theEventFlow.print(cout);
+  theMuonFlow.print(cout);
 }
 
 
@@ -28,6 +28,8 @@
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
 
 #include "DataFormats/PatCandidates/interface/Muon.h"
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+#include "UserCode/HSCPTOF/interface/CutFlow.h"
 #include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
 #include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
 #include "RecoMuon/TrackingTools/interface/MuonSegmentMatcher.h"
@@ -79,7 +81,12 @@ private:
   bool theDebug;
   bool doSim;
   double theAngleCut;
+  CosmicPairTagger theCosmicTagger;
   double thePtCut;
+  // event and muon cut flows, stages in the order of the enums
+  enum { evAll, evBeamSpot, evMuons };
+  enum { muAll, muPt };
+  CutFlow theEventFlow, theMuonFlow;
 
   edm::EDGetTokenT<reco::BeamSpot> beamSpotToken_;
   edm::EDGetTokenT<reco::TrackCollection> trackToken_;
@@ -92,7 +92,14 @@ GlobalMuonValidator::GlobalMuonValidator(const edm::ParameterSet& iConfig)
   theInvPt(iConfig.getParameter<double>("invPtScale")),
   theNBins(iConfig.getParameter<int>("nbins")),
   theDTRecHitLabel(iConfig.getUntrackedParameter<edm::InputTag>("DTRecHits")),
-  theCSCRecHitLabel(iConfig.getUntrackedParameter<edm::InputTag>("CSCRecHits"))
+  theCSCRecHitLabel(iConfig.getUntrackedParameter<edm::InputTag>("CSCRecHits")),
+  theSnapshotOut(iConfig.getUntrackedParameter<string>("snapshotOut","globalMuonValidator_snapshot.root")),
+  theSnapshotEvents(iConfig.getUntrackedParameter<unsigned int>("snapshotEvents",0)),
+  theSnapshotSeconds(iConfig.getUntrackedParameter<double>("snapshotSeconds",0.)),
+  theEventFlow("eventCutFlow", {"all","has muons"}),
+  theMuonFlow("muonCutFlow", {"all","GlobalMuonPromptTight","eta"}),
+  theRecHitsLoaded(false),
+  theSnapshots(0)
 {
   //now do what ever initialization is needed
 
@@ -110,6 +117,7 @@ GlobalMuonValidator::~GlobalMuonValidator()
  
    // do anything here that needs to be done at desctruction time
    // (e.g. close files, deallocate resources etc.)
+  delete theSnapshots;
   if (hFile!=0) {
     hFile->Close();
     delete hFile;
@@ -134,6 +142,13 @@ GlobalMuonValidator::analyze(const edm::Event& iEvent, const edm::EventSetup& iS
 
 //  cout << "*** Begin Muon Validatior " << endl;
 
+  if (theSnapshots->newEvent()) {
+    vector<TObject*> objects;
+    HistSnapshotWriter::cloneHistograms(hFile, objects);
+    theSnapshots->submit(objects);
+  }
+  theEventFlow.pass(evAll);
+
   // Update the services
   theService->update(iSetup);
 
@@ -142,17 +157,19 @@ GlobalMuonValidator::analyze(const edm::Event& iEvent, const edm::EventSetup& iS
 
   iEvent.getByLabel(theDTRecHitLabel, theDTRecHits);
   iEvent.getByLabel(theCSCRecHitLabel, theCSCRecHits);
-
-  ESHandle<GlobalTrackingGeometry> theTrackingGeometry;
-  iSetup.get<GlobalTrackingGeometryRecord>().get(theTrackingGeometry);
+  theRecHitsLoaded = false;
 
   MuonCollection::const_iterator imuon;
   if (!muonC.size()) return;
+  theEventFlow.pass(evMuons);
 
   for(imuon = muonC.begin(); imuon != muonC.end(); ++imuon){
     
+    theMuonFlow.pass(muAll);
     if (!muon::isGoodMuon(*imuon, muon::GlobalMuonPromptTight )) continue;
+    theMuonFlow.pass(muGlobal);
     if ((fabs(imuon->eta())<theMinEta) || (fabs(imuon->eta())>theMaxEta)) continue;
+    theMuonFlow.pass(muEta);
     
     hi_glb6_pt->Fill(imuon->pt());
     
@@ -342,12 +359,15 @@ GlobalMuonValidator::beginJob()
   hi_sho_p    = new TH2F("hi_sho_p","Number of showered chambers vs reco P",theNBins,0.0,theMaxPtres,5,0,5);
   hi_sho_eta  = new TH2F("hi_sho_eta","Number of showered chambers vs reco Eta",theNBins/4,0.,theMaxEta,5,0,5);
 
+  theSnapshots = new HistSnapshotWriter(theSnapshotOut, theSnapshotEvents, theSnapshotSeconds);
 }
 
 // ------------ method called once each job just after ending the event loop  ------------
 void 
 GlobalMuonValidator::endJob() {
 
+  theSnapshots->stop();
+
   hFile->cd();
 
   gROOT->SetStyle("effStyle");
@@ -400,7 +420,20 @@ GlobalMuonValidator::endJob() {
   hi_sho_p->Write();
   hi_sho_eta->Write();
 
+  hFile->mkdir("cutflow");
+  hFile->cd("cutflow");
+  for (const CutFlow* flow : {&theEventFlow, &theMuonFlow}) {
+    TH1F* h = flow->histogram();
+    h->Write();
+    delete h;
+  }
+
+  hFile->cd();
   hFile->Write();
+
+  cout << endl;
+  theEventFlow.print(cout);
+  theMuonFlow.print(cout);
 }
 
 float 
@@ -521,68 +554,46 @@ GlobalMuonValidator::trackProbability(const Track& track) const {
 //
 //
 void GlobalMuonValidator::checkMuonHits(const reco::Track& muon, 
-				       std::vector<int>& hits) const {
-
-  float coneSize = 20.0;
-  int dethits[4];
-  for ( int i=0; i<4; i++ ) hits[i]=dethits[i]=0;
+				       std::vector<int>& hits) {
+
+  // the rechits of the event are sorted by layer once, for all the muons
+  if (!theRecHitsLoaded) {
+    theHitCounter.clear();
+    for (DTRecHitCollection::const_iterator ir = theDTRecHits->begin(); ir != theDTRecHits->end(); ir++)
+      theHitCounter.addDTRecHit(ir->wireId().layerId().rawId(), ir->localPosition().x());
+    for (CSCRecHit2DCollection::const_iterator ir = theCSCRecHits->begin(); ir != theCSCRecHits->end(); ir++)
+      theHitCounter.addCSCRecHit(ir->cscDetId().rawId(), ir->localPosition().x(), ir->localPosition().y());
+    theHitCounter.build();
+    theRecHitsLoaded = true;
+  }
 
-  // loop through all muon hits and calculate the maximum # of hits in each chamber
+  // DT and CSC hits of the muon, the maximum # of rechits near them is taken in each station
+  theTrackHits.clear();
   for (trackingRecHit_iterator imrh = muon.recHitsBegin(); imrh != muon.recHitsEnd(); imrh++ ) {
         
     if (!(*imrh)->isValid()) continue;
-  
-    int station = 0;
-    int detRecHits = 0;
       
     DetId id = (*imrh)->geographicalId();
 
     // Skip tracker hits
     if (id.det()!=DetId::Muon) continue;
       
+    LocalPoint pos = (*imrh)->localPosition();
     if ( id.subdetId() == MuonSubdetId::DT ) {
-
-      DTChamberId did(id.rawId());
       DTLayerId lid(id.rawId());
-      station = did.station();
-//      cout << " Station " << station << " DT layer: " << lid.layer() << endl;
-
-      // Get the DT-Segment which relies on this chamber
-      DTRecHitCollection::range dRecHits = theDTRecHits->get(lid);
-	
-      for (DTRecHitCollection::const_iterator ir = dRecHits.first; ir != dRecHits.second; ir++ ) {
-	double rhitDistance = fabs(ir->localPosition().x()-(**imrh).localPosition().x());
-	if ( rhitDistance < coneSize ) detRecHits++;
-//             cout << "       " << (ir)->localPosition() << "  " << (**imrh).localPosition()
-//	     << " Distance: " << rhitDistance << " recHits: " << detRecHits << endl;
-      }
-    }// end of if DT
+      MuonHitCounter::TrackHit hit = {lid.rawId(), MuonHitCounter::DT, lid.station(), lid.layer(), pos.x(), pos.y()};
+      theTrackHits.push_back(hit);
+    }
     else if ( id.subdetId() == MuonSubdetId::CSC ) {
-    
       CSCDetId did(id.rawId());
-      // Get the CSC-Segment which relies on this chamber
-      CSCRecHit2DCollection::range dRecHits = theCSCRecHits->get(did);      
-    
-      station = did.station();
-//      cout << " Station " << station << " CSC layer: " << did.layer() << endl;
-
-      for (CSCRecHit2DCollection::const_iterator ir = dRecHits.first; ir != dRecHits.second; ir++ ) {
-	double rhitDistance = (ir->localPosition()-(**imrh).localPosition()).mag();
-	if ( rhitDistance < coneSize ) detRecHits++;
-//	cout << ir->localPosition() << "  " << (**imrh).localPosition()
-//	     << " Distance: " << rhitDistance << " recHits: " << detRecHits << endl;
-      }
-    }
-    else {
-//      cout<<" Wrong Hit Type " << endl;
-      continue;      
-    }
-      
-    if ( (station > 0) && (station < 5) ) {
-      if ( detRecHits > hits[station-1] ) hits[station-1] = detRecHits;
+      MuonHitCounter::TrackHit hit = {did.rawId(), MuonHitCounter::CSC, did.station(), did.layer(), pos.x(), pos.y()};
+      theTrackHits.push_back(hit);
     }
+  }
 
-  } // end of loop over muon rechits
+  int stations[4];
+  theHitCounter.countRecHits(theTrackHits, stations);
+  for ( int i=0; i<4; i++ ) hits[i]=stations[i];
 
 }
 
@@ -25,6 +25,9 @@
 #include "DataFormats/CSCRecHit/interface/CSCSegmentCollection.h"
 #include "DataFormats/MuonReco/interface/Muon.h"
 #include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "UserCode/HSCPTOF/interface/HistSnapshotWriter.h"
+#include "UserCode/HSCPTOF/interface/CutFlow.h"
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
 
 #include <TROOT.h>
 #include <TSystem.h>
@@ -65,7 +68,7 @@ private:
   virtual float calculateDistance(const math::XYZVector&, const math::XYZVector&);
   const Track*  chooseTrack(vector<const Track*> t, int muonHitsOption, int p1, int p2) const;
   double trackProbability(const Track& track) const;
-  void checkMuonHits(const reco::Track& muon, std::vector<int>& hits) const;
+  void checkMuonHits(const reco::Track& muon, std::vector<int>& hits);
 
 
   // ----------member data ---------------------------
@@ -75,6 +78,13 @@ private:
   string out, open;
   double  theMinEta, theMaxEta, theMinPt, thePtCut, theMinPtres, theMaxPtres, theInvPt;
   int theNBins;
+  string theSnapshotOut;
+  unsigned int theSnapshotEvents;
+  double theSnapshotSeconds;
+  // event and muon cut flows, stages in the order of the enums
+  enum { evAll, evMuons };
+  enum { muAll, muGlobal, muEta };
+  CutFlow theEventFlow, theMuonFlow;
 
   Handle<reco::MuonCollection> MuCollection;
   Handle<reco::TrackCollection> TKTrackCollection;
@@ -88,10 +98,18 @@ private:
   Handle<DTRecHitCollection>    theDTRecHits;
   Handle<CSCRecHit2DCollection> theCSCRecHits;
 
+  // DT/CSC rechits of the event sorted by layer, added at the first checkMuonHits call
+  MuonHitCounter theHitCounter;
+  bool theRecHitsLoaded;
+  vector<MuonHitCounter::TrackHit> theTrackHits;
+
   //ROOT Pointers
   TFile* hFile;
   TStyle* effStyle;
 
+  // periodic snapshots of the histograms, written by a background thread
+  HistSnapshotWriter* theSnapshots;
+
   TH1F* hi_sta_pt  ;
   TH1F* hi_tk_pt  ;
   TH1F* hi_glb_pt  ;
@@ -0,0 +1,95 @@
+// -*- C++ -*-
+//
+// Package:    HSCPPreselectionFilter
+// Class:      HSCPPreselectionFilter
+//
+/**\class HSCPPreselectionFilter HSCPPreselectionFilter.cc
+
+ Description: Cheap muon-level preselection in front of the timing analyzers
+
+ Implementation:
+     The cuts are the MuonTimingCuts of the analyzers, evaluated on the
+     muon summary data only (pt, eta, ID bits, Muon::time() and rpcTime()).
+*/
+
+#include "HSCPPreselectionFilter.h"
+
+// system include files
+#include <iostream>
+#include <iomanip>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+//
+// constructors and destructor
+//
+HSCPPreselectionFilter::HSCPPreselectionFilter(const edm::ParameterSet& iConfig)
+  :
+  MuonTags_(iConfig.getUntrackedParameter<edm::InputTag>("Muons")),
+  theMuonCuts(iConfig.getParameter<double>("PtCut"),
+              iConfig.getParameter<double>("etaMin"),
+              iConfig.getParameter<double>("etaMax"),
+              iConfig.getParameter<string>("requireId"),
+              MuonTimingCuts::embeddedTimeVariables()),
+  theMinMuons(iConfig.getParameter<unsigned int>("minMuons")),
+  theNEvents(0),
+  theNPassed(0),
+  theNMuons(0),
+  theNMuonsKin(0),
+  theNMuonsId(0)
+{
+  muonToken_ = consumes<edm::View<reco::Muon> >(MuonTags_);
+}
+
+HSCPPreselectionFilter::~HSCPPreselectionFilter() {
+}
+
+//
+// member functions
+//
+
+// ------------ method called to for each event  ------------
+bool
+HSCPPreselectionFilter::filter(edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  theNEvents++;
+
+  Handle<edm::View<reco::Muon> > muons;
+  iEvent.getByToken(muonToken_, muons);
+
+  unsigned int nGood = 0;
+  for (edm::View<reco::Muon>::const_iterator imuon = muons->begin(); imuon != muons->end(); ++imuon) {
+    theNMuons++;
+    if (!theMuonCuts.passKinematics(*imuon)) continue;
+    theNMuonsKin++;
+    if (!theMuonCuts.passId(*imuon, MuonTimingCuts::timeInfo(*imuon), 0)) continue;
+    theNMuonsId++;
+    nGood++;
+  }
+
+  if (nGood<theMinMuons) return false;
+  theNPassed++;
+  return true;
+}
+
+
+void
+HSCPPreselectionFilter::beginJob() {
+}
+
+void
+HSCPPreselectionFilter::endJob() {
+  cout << endl << " HSCPPreselectionFilter: " << theNPassed << " / " << theNEvents << " events accepted";
+  if (theNEvents) cout << " (" << setprecision(4) << 100.*theNPassed/theNEvents << "%)";
+  cout << endl;
+  cout << "   muons: " << theNMuons << " total, " << theNMuonsKin << " pass pt/eta, "
+       << theNMuonsId << " pass ID" << endl;
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(HSCPPreselectionFilter);
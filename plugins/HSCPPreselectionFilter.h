@@ -0,0 +1,53 @@
+#ifndef UserCode_HSCPTOF_HSCPPreselectionFilter_H
+#define UserCode_HSCPTOF_HSCPPreselectionFilter_H
+
+/** \class HSCPPreselectionFilter
+ *  Keeps the events with at least minMuons muons passing the muon-level cuts
+ *  of the timing analyzers (PtCut, eta window, requireId).
+ *
+ *  Only the muon collection is read (reco::Muon or pat::Muon), so it can run
+ *  in front of the analyzers and skip the events that none of their muons
+ *  could pass. The tight ID is applied without the vertex cuts.
+ */
+
+// Base Class Headers
+#include "FWCore/Framework/interface/EDFilter.h"
+#include "FWCore/Framework/interface/Event.h"
+
+#include "DataFormats/Common/interface/View.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "UserCode/HSCPTOF/interface/MuonTimingCuts.h"
+
+namespace edm {
+  class ParameterSet;
+  class EventSetup;
+  class InputTag;
+}
+
+using namespace std;
+using namespace edm;
+using namespace reco;
+
+class HSCPPreselectionFilter : public edm::EDFilter {
+public:
+  explicit HSCPPreselectionFilter(const edm::ParameterSet&);
+  ~HSCPPreselectionFilter();
+
+private:
+  virtual void beginJob() ;
+  virtual bool filter(edm::Event&, const edm::EventSetup&);
+  virtual void endJob() ;
+
+  // ----------member data ---------------------------
+
+  edm::InputTag MuonTags_;
+  edm::EDGetTokenT<edm::View<reco::Muon> > muonToken_;
+
+  MuonTimingCuts theMuonCuts;
+  unsigned int theMinMuons;
+
+  // acceptance counters
+  unsigned long long theNEvents, theNPassed;
+  unsigned long long theNMuons, theNMuonsKin, theNMuonsId;
+};
+#endif
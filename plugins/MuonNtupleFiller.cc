@@ -26,6 +26,7 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <cmath>
 
 // user include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
@@ -102,7 +103,25 @@ MuonNtupleFiller::MuonNtupleFiller(const edm::ParameterSet& iConfig)
   debug_(iConfig.getParameter<bool>("debug")),
   doSim(iConfig.getParameter<bool>("mctruthMatching")),
   theAngleCut(iConfig.getParameter<double>("angleCut")),
-  thePtCut(iConfig.getParameter<double>("PtCut"))
+  theCosmicTagger(theAngleCut),
+  thePtCut(iConfig.getParameter<double>("PtCut")),
+  theEventFlow("eventCutFlow", {"all","beam spot","has muons","leading loose pt"}),
+  theMuonFlow("muonCutFlow", {"all","standalone","pt>5"}),
+  thePhaseTimer("MuonNtupleFiller", {"fetch","selection","truth","L1","segments","fill"},
+                iConfig.getParameter<bool>("phaseTiming") || iConfig.getParameter<bool>("phaseCounters"),
+                iConfig.getParameter<unsigned int>("slowEvents"), iConfig.getParameter<bool>("phaseCounters")),
+  theMemoryReport(iConfig.getParameter<bool>("memoryReport")),
+  theMemoryEvents(iConfig.getParameter<unsigned int>("memoryReportEvents")),
+  theNEvents(0),
+  theRPCHitsLoaded(false),
+  theIndexCuts(0.,0.,999.,iConfig.getParameter<string>("indexSelection")),
+  theIndexOut(iConfig.getParameter<string>("indexOut")),
+  theIndex(0),
+  theIndexFile(0),
+  theDetailCuts(0.,0.,999.,iConfig.getParameter<string>("detailSelection")),
+  theDetails(!theDetailCuts.selection().empty()),
+  theDetailsLoaded(false),
+  theCalibration(iConfig.getParameter<string>("timeCalibration"))
 {
   edm::ConsumesCollector collector(consumesCollector());
 
@@ -129,6 +148,7 @@ MuonNtupleFiller::MuonNtupleFiller(const edm::ParameterSet& iConfig)
 
 MuonNtupleFiller::~MuonNtupleFiller()
 {
+  delete theIndex;
   if (hFile!=0) {
     hFile->Close();
     delete hFile;
@@ -180,9 +200,14 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   event_run = iEvent.id().run();
   event_lumi = iEvent.id().luminosityBlock();
   event_event = iEvent.id().event();
+  thePhaseTimer.startEvent(event_run, event_lumi, event_event);
+  theCalibration.update(event_run);
 
   if (debug_)
     cout << endl << " Event: " << iEvent.id() << "  Orbit: " << iEvent.orbitNumber() << "  BX: " << iEvent.bunchCrossing() << endl;
+  theEventFlow.pass(evAll);
+  if (theMemoryReport && theMemoryEvents && ++theNEvents % theMemoryEvents == 0)
+    reportMemory("event " + to_string(theNEvents));
 
   weight = 1.;
   if( !iEvent.isRealData() ) {
@@ -218,6 +243,7 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
       cout << "No beam spot available from EventSetup." << endl;
       return;
     }
+  theEventFlow.pass(evBeamSpot);
   math::XYZPoint beamspot(beamSpot.x0(),beamSpot.y0(), beamSpot.z0());
 
   const reco::Vertex pvertex(posVtx,errVtx);
@@ -231,6 +257,7 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   if (!TruthTrackContainer.isValid()) {
     if (debug_) cout << " No TrackingParticle data in the Event" << endl;
   } else tpart=true;
+  thePhaseTimer.mark(phFetch);
 
   const TrackingParticleCollection *tPC=0;
   if (tpart) 
@@ -247,48 +274,54 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   if (doSim)   
     iEvent.getByToken(genParticleToken_, genParticles);
 
+  // generated and TrackingParticle muons for the truth matching
+  theGenMatcher.clear();
+  if (doSim)
+    for (const auto &iTrack : *genParticles)
+      if (fabs(iTrack.pdgId())==13 && iTrack.p4().Pt()>2)
+        theGenMatcher.add(&iTrack - &genParticles->front(), iTrack.p4().eta(), iTrack.p4().phi());
+  theTpMatcher.clear();
+  if (tpart)
+    for (const auto &iTrack : *tPC)
+      if (fabs(iTrack.pdgId())==13 && iTrack.p4().Pt()>2)
+        theTpMatcher.add(&iTrack - &tPC->front(), iTrack.p4().eta(), iTrack.p4().phi());
+  thePhaseTimer.mark(phTruth);
+
   iEvent.getByToken(muonToken_,MuCollection);
   const reco::MuonCollection muonC = *(MuCollection.product());
   if (debug_) cout << " Muon collection size: " << muonC.size() << endl;
+  thePhaseTimer.setSizes(muonC.size(), tpart ? tPC->size() : 0, 0);
+  thePhaseTimer.mark(phFetch);
   if (!muonC.size()) return;
-  MuonCollection::const_iterator imuon,iimuon;
-
-  edm::Handle<edm::ValueMap<reco::MuonShower> > muonShowerInformationValueMapH_;
-  iEvent.getByToken(muons_muonShowerInformation_token_, muonShowerInformationValueMapH_);
+  theEventFlow.pass(evMuons);
+  MuonCollection::const_iterator imuon;
 
   double maxpt=0;
 
-  float angle=0;
-  isCosmic=0;
+  // find the leading loose muon and check for back-to-back dimuons
+  theCosmicTagger.clear();
   for(imuon = muonC.begin(); imuon != muonC.end(); ++imuon) {
 
 //    if (muon::isHighPtMuon(*imuon, pvertex )) 
 //      if (imuon->tunePMuonBestTrack()->pt()>maxpt) 
 //        maxpt=imuon->tunePMuonBestTrack()->pt();
     if (imuon->pt()>maxpt && muon::isLooseMuon(*imuon)) maxpt=imuon->pt();
-      
-    // check for back-to-back dimuons
-    if (muonC.size()>1) {
-      if ((imuon->isGlobalMuon() || imuon->isTrackerMuon()) && (imuon->track().isNonnull())) {
-        for(iimuon = imuon+1; iimuon != muonC.end(); ++iimuon) 
-          if ((iimuon->isGlobalMuon() || iimuon->isTrackerMuon()) && (iimuon->track().isNonnull())) {
-            double cross = imuon->track()->momentum().Dot(iimuon->track()->momentum());
-            angle = acos(-cross/iimuon->track()->p()/imuon->track()->p());
-            if (angle<theAngleCut) isCosmic=1;
-          }
-      }
-    }
+
+    if ((imuon->isGlobalMuon() || imuon->isTrackerMuon()) && (imuon->track().isNonnull()))
+      theCosmicTagger.add(imuon-muonC.begin(), imuon->track()->px(), imuon->track()->py(), imuon->track()->pz());
   }
+  isCosmic = !theCosmicTagger.tag().empty();
+  thePhaseTimer.mark(phSelection);
 
   // only store events with a good quality high pT muon
   if (maxpt<thePtCut) {
     if (debug_) cout << "max pT below threshold at : " << maxpt << " GeV. Aborting" << endl;
     return;
   }
+  theEventFlow.pass(evLeadingPt);
 
-  // Analyze L1 information
-  edm::Handle<l1t::MuonBxCollection> muColl;
-  iEvent.getByToken(muCollToken_, muColl);
+  // L1 candidates, segments and shower information are read on the first muon that needs them
+  theDetailsLoaded = false;
 
   iEvent.getByToken(timeMapCmbToken_,timeMap1);
 //  const reco::MuonTimeExtraMap & timeMapCmb = *timeMap1;
@@ -296,6 +329,7 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   const reco::MuonTimeExtraMap & timeMapDT = *timeMap2;
   iEvent.getByToken(timeMapCSCToken_,timeMap3);
   const reco::MuonTimeExtraMap & timeMapCSC = *timeMap3;
+  thePhaseTimer.mark(phFetch);
 
   int imucount=0;
 
@@ -307,6 +341,7 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     
     reco::MuonRef muonR(MuCollection,imucount);
     imucount++;    
+    theMuonFlow.pass(muAll);
 
     if (debug_) 
       cout << endl << "   Found muon. Pt: " << imuon->pt() << "   eta: " << imuon->eta() << endl;
@@ -314,15 +349,18 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     reco::TrackRef glbTrack = imuon->combinedMuon();
     reco::TrackRef trkTrack = imuon->track();
     reco::TrackRef staTrack = imuon->standAloneMuon();
-    reco::MuonShower muonShowerInformation = (*muonShowerInformationValueMapH_)[muonR];
-    
     // MuonTimeExtra timec = timeMapCmb[muonR];
     MuonTimeExtra timedt = timeMapDT[muonR];
     MuonTimeExtra timecsc = timeMapCSC[muonR];
     reco::MuonTime timerpc = imuon->rpcTime();
     reco::MuonTime timemuon = imuon->time();
+    MuonTimingCuts::MuonTimeInfo times;
+    if (theIndex || theDetails)
+      times = MuonTimingCuts::timeInfo(*imuon, (*timeMap1)[muonR], timedt, timecsc);
+    if (theIndex && theIndexCuts.passId(*imuon, times, &pvertex)) addToIndex(iEvent, imuon-muonC.begin(), *imuon, times);
 
     hasSim = 0;
+    hasL1 = 0;
     isSTA = staTrack.isNonnull();
     isGLB = glbTrack.isNonnull();
     isLoose = muon::isLooseMuon(*imuon);
@@ -342,61 +380,46 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
 
     // remove some junk, the files are getting too big
     if (!isSTA) continue;
+    theMuonFlow.pass(muSTA);
     if (pt < 5) continue;
+    theMuonFlow.pass(muPt);
+
+    // segments, shower, L1 and truth only for the muons passing detailSelection
+    hasDetails = !theDetails || theDetailCuts.passId(*imuon, times, &pvertex);
+    thePhaseTimer.mark(phSelection);
+    if (hasDetails && !theDetailsLoaded) loadDetails(iEvent, muonC);
 
 //    vector<int> rpchits={0,0,0,0};
     vector<int> segments_all={0,0,0,0};
-    if (isSTA) {
-      vector<int> segments_csc={0,0,0,0};
-      segments_all=countDTsegs(iEvent,muonR);
-      segments_csc=countCSCsegs(iEvent,muonR);
-      for (int i=0;i<4;i++) 
-        segments_all[i]+=segments_csc[i];
-    }
+    if (isSTA && hasDetails) segments_all=countSegments(*imuon, timemuon.nDof ? timemuon.timeAtIpInOut : 0);
+      else
+        for (int i=0; i<4; i++)
+          dtSegTime[i] = dtSegRes[i] = dtSegHits[i] = cscSegTime[i] = cscSegRes[i] = cscSegHits[i] = noSegment;
+    thePhaseTimer.mark(phSegments);
     
 //    double detaphi=999;
     int l1idx=0;
     for (int i=0;i<10;i++) l1Pt[i]=0;
     genPt=0;
     // get L1 information
-    for (int ibx=muColl->getFirstBX(); ibx<=muColl->getLastBX(); ibx++)
-      for (auto it = muColl->begin(ibx); it != muColl->end(ibx); it++){
-        l1t::MuonRef l1muon(muColl, distance(muColl->begin(muColl->getFirstBX()),it) );
-        double deta=fabs(l1muon->eta()-eta);
-        double dphi=fabs(reco::deltaPhi(l1muon->phi(),phi));
-//        double dr=sqrt(deta*deta+dphi*dphi);
-        
-        // insert a protection against cross-matching L1 candidates for close-by muons
-        // If the L1 candidate dR w.r.t. a different Loose muon is smaller then don't look at the candidate here
-        // (it's blocked by blowing up the dr so that it's not accepted by the dr<0.15 cut)
-        for(iimuon = muonC.begin(); iimuon != muonC.end(); ++iimuon){
-          if (iimuon!=imuon && iimuon->pt()>thePtCut && muon::isLooseMuon(*iimuon)) {
-            double deta2=fabs(l1muon->eta()-iimuon->tunePMuonBestTrack()->eta());
-            double dphi2=fabs(reco::deltaPhi(l1muon->phi(),iimuon->tunePMuonBestTrack()->phi()));
-//            double dr2=sqrt(deta2*deta2+dphi2*dphi2);
-            if (deta2<deta && dphi2<dphi) {
-              deta=1.;
-              dphi=1.;
-              break;
-            }
-          }
-        }
-
-        // any L1 match falling inside the cone is saved
-        // NEW: tight matching in phi and loose in eta
-        if (dphi<0.1 && deta<0.4) {
-          hasL1=1;
-          l1Pt[l1idx]=l1muon->pt();
-          l1Eta[l1idx]=l1muon->eta();
-          l1Phi[l1idx]=l1muon->phi();
-          l1Qual[l1idx]=l1muon->hwQual();
-          l1BX[l1idx]=ibx;
-          if (l1idx==9) cout << " Too many L1 matches..." << endl;
-            else l1idx++;
-        }
+    if (hasDetails) theL1Matcher.matchL1(imuon-muonC.begin(), eta, phi, theLooseMuons, theL1Matches);
+      else theL1Matches.clear();
+    for (unsigned int idx : theL1Matches) {
+      // any L1 match falling inside the cone is saved
+      // NEW: tight matching in phi and loose in eta
+      l1t::MuonRef l1muon(theL1Muons, idx);
+      hasL1=1;
+      l1Pt[l1idx]=l1muon->pt();
+      l1Eta[l1idx]=l1muon->eta();
+      l1Phi[l1idx]=l1muon->phi();
+      l1Qual[l1idx]=l1muon->hwQual();
+      l1BX[l1idx]=theL1BX[idx];
+      if (l1idx==9) cout << " Too many L1 matches..." << endl;
+        else l1idx++;
     }
     
     if (debug_) cout << " found " << l1idx << " L1 matches." << endl;
+    thePhaseTimer.mark(phL1);
 
     muNdof = timemuon.nDof;
     muTime = timemuon.timeAtIpInOut;
@@ -412,63 +435,59 @@ MuonNtupleFiller::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
     cscTime = timecsc.timeAtIpInOut();
 
     // read muon shower information
-    for (int i=0; i<4; i++) { // Loop on stations
-      nhits[i]  = (muonShowerInformation.nStationHits).at(i);        // number of all the muon RecHits per chamber crossed by a track (1D hits)
-      nsegs[i] = segments_all.at(i);
-    }
+    if (hasDetails) {
+      const reco::MuonShower& muonShowerInformation = (*theShowers)[muonR];
+      for (int i=0; i<4; i++)  // Loop on stations
+        nhits[i]  = (muonShowerInformation.nStationHits).at(i);        // number of all the muon RecHits per chamber crossed by a track (1D hits)
+    } else
+      for (int i=0; i<4; i++) nhits[i] = 0;
+    for (int i=0; i<4; i++) nsegs[i] = segments_all.at(i);
 
-    bool matched=false;
+    thePhaseTimer.mark(phSelection);
 
-    if (doSim) 
-      for (const auto &iTrack : *genParticles) 
-        if (fabs(iTrack.pdgId())==13 && iTrack.p4().Pt()>2) {
-          if (debug_) cout << iTrack.p4().Pt() << endl;
-          if (trkTrack.isNonnull())
-            if ((fabs(iTrack.p4().eta()-imuon->track()->momentum().eta())<0.05) &&
-                (fabs(reco::deltaPhi(iTrack.p4().phi(),imuon->track()->momentum().phi()))<0.05)) 
-              matched=true;
-          if (staTrack.isNonnull())
-            if ((fabs(iTrack.p4().eta()-staTrack->momentum().eta())<0.05) &&
-                (fabs(reco::deltaPhi(iTrack.p4().phi(),staTrack->momentum().phi()))<0.05))
-              matched=true;
-
-          if (matched==true) {
-            hasSim=1;
-            genPt=iTrack.p4().Pt();
-            genEta=iTrack.p4().Eta();
-            genPhi=iTrack.p4().Phi();
-            genCharge=iTrack.pdgId()/13;
-            break;
-          }
+    bool matched=false;
+    bool hasTrk=trkTrack.isNonnull();
+    float trkEta = hasTrk ? trkTrack->momentum().eta() : 0, trkPhi = hasTrk ? trkTrack->momentum().phi() : 0;
+    float staEta = isSTA ? staTrack->momentum().eta() : 0, staPhi = isSTA ? staTrack->momentum().phi() : 0;
+
+    if (doSim && hasDetails) {
+      int igen = theGenMatcher.matchTruth(hasTrk, trkEta, trkPhi, isSTA, staEta, staPhi);
+      if (igen>=0) {
+        const GenParticle& gen = (*genParticles)[igen];
+        matched=true;
+        hasSim=1;
+        genPt=gen.p4().Pt();
+        genEta=gen.p4().Eta();
+        genPhi=gen.p4().Phi();
+        genCharge=gen.pdgId()/13;
       }
+    }
 
-    if (tpart) {
-      for (const auto &iTrack : *tPC)
-        if (fabs(iTrack.pdgId())==13 && iTrack.p4().Pt()>2) {
-          if (debug_) cout << iTrack.p4().Pt() << endl;
-          if (trkTrack.isNonnull())
-            if ((fabs(iTrack.p4().eta()-imuon->track()->momentum().eta())<0.05) &&
-                (fabs(reco::deltaPhi(iTrack.p4().phi(),imuon->track()->momentum().phi()))<0.05)) 
-              matched=true;
-          if (staTrack.isNonnull())
-            if ((fabs(iTrack.p4().eta()-staTrack->momentum().eta())<0.05) &&
-                (fabs(reco::deltaPhi(iTrack.p4().phi(),staTrack->momentum().phi()))<0.05))
-              matched=true;
-
-          if (matched==true) {
-            hasSim=1;
-            genPt=iTrack.p4().Pt();
-            genEta=iTrack.p4().Eta();
-            genPhi=iTrack.p4().Phi();
-            genBX=iTrack.eventId().bunchCrossing();
-            genCharge=iTrack.pdgId()/13;
-            break;
-          }
-        }
+    if (tpart && hasDetails) {
+      // the match flag is shared with the generator matching: after a generator match the first muon is taken
+      int itp = -1;
+      if (!matched) itp = theTpMatcher.matchTruth(hasTrk, trkEta, trkPhi, isSTA, staEta, staPhi);
+        else if (theTpMatcher.size()) itp = theTpMatcher.index(0);
+      if (itp>=0) {
+        const TrackingParticle& tp = (*tPC)[itp];
+        matched=true;
+        hasSim=1;
+        genPt=tp.p4().Pt();
+        genEta=tp.p4().Eta();
+        genPhi=tp.p4().Phi();
+        genBX=tp.eventId().bunchCrossing();
+        genCharge=tp.pdgId()/13;
+      }
     }
 
+    thePhaseTimer.mark(phTruth);
+
     t->Fill();
+    thePhaseTimer.mark(phFill);
   }
+  if (theDetailsLoaded)
+    thePhaseTimer.setSizes(muonC.size(), tpart ? tPC->size() : 0,
+                           theHitCounter.size(MuonHitCounter::DTSegments) + theHitCounter.size(MuonHitCounter::CSCSegments));
 
 }
 
@@ -488,6 +507,7 @@ MuonNtupleFiller::beginJob()
 //   t->Branch("genEta", &genEta, "genEta/F");
 //   t->Branch("genBX", &genBX, "genBX/I");
 
+   t->Branch("hasDetails", &hasDetails, "hasDetails/O");
    t->Branch("hasL1", &hasL1, "hasL1/O");
    t->Branch("l1Qual", &l1Qual, "l1Qual[10]/I");
    t->Branch("l1Pt", &l1Pt, "l1Pt[10]/F");
@@ -522,6 +542,12 @@ MuonNtupleFiller::beginJob()
 //   t->Branch("nrpchits", &nrpchits, "nrpchits[4]/I");
    t->Branch("nsegs", &nsegs, "nsegs[4]/I");
 //   t->Branch("nmatches", &nmatches, "nmatches[4]/I");
+   t->Branch("dtSegTime", &dtSegTime, "dtSegTime[4]/S");
+   t->Branch("dtSegRes", &dtSegRes, "dtSegRes[4]/S");
+   t->Branch("dtSegHits", &dtSegHits, "dtSegHits[4]/S");
+   t->Branch("cscSegTime", &cscSegTime, "cscSegTime[4]/S");
+   t->Branch("cscSegRes", &cscSegRes, "cscSegRes[4]/S");
+   t->Branch("cscSegHits", &cscSegHits, "cscSegHits[4]/S");
 
 //   t->Branch("muNdof", &muNdof, "muNdof/I");
 //   t->Branch("muTime", &muTime, "muTime/F");
@@ -533,6 +559,9 @@ MuonNtupleFiller::beginJob()
    t->Branch("rpcNdof", &rpcNdof, "rpcNdof/I");
    t->Branch("rpcTime", &rpcTime, "rpcTime/F");
    t->Branch("rpcTimeErr", &rpcTimeErr, "rpcTimeErr/F");
+
+   if (!theIndexCuts.selection().empty()) theIndex = new EventIndexWriter(theIndexOut);
+   if (theMemoryReport) reportMemory("beginJob");
 }
 
 // ------------ method called once each job just after ending the event loop  ------------
@@ -541,182 +570,213 @@ MuonNtupleFiller::endJob() {
 
   hFile->cd();
   t->Write();
+  hFile->mkdir("cutflow");
+  hFile->cd("cutflow");
+  for (const CutFlow* flow : {&theEventFlow, &theMuonFlow}) {
+    TH1F* h = flow->histogram();
+    h->Write();
+    delete h;
+  }
+  thePhaseTimer.finish();
+  if (theMemoryReport) reportMemory("endJob");
+  if (thePhaseTimer.enabled()) {
+    hFile->mkdir("timing");
+    hFile->cd("timing");
+    for (unsigned int i = 0; i <= thePhaseTimer.size(); i++) {
+      TH1F* h = thePhaseTimer.histogram(i);
+      h->Write();
+      delete h;
+    }
+  }
+  hFile->cd();
   hFile->Write();
   delete t;  
-}
 
-double MuonNtupleFiller::iMass(reco::TrackRef imuon, reco::TrackRef iimuon) {
-  double energy1 = sqrt(imuon->p() * imuon->p() + 0.011163691);
-  double energy2 = sqrt(iimuon->p() * iimuon->p() + 0.011163691);
-  math::XYZTLorentzVector ip4(imuon->px(),imuon->py(),imuon->pz(),energy1);
-  math::XYZTLorentzVector iip4(iimuon->px(),iimuon->py(),iimuon->pz(),energy2);
-  math::XYZTLorentzVector psum = ip4+iip4;
-  double mmumu2 = psum.Dot(psum);
-  return sqrt(mmumu2);
-}
-
-vector<int> MuonNtupleFiller::countRPChits(reco::TrackRef muon, const edm::Event& iEvent) {
-  double RPCCut = 30.;
+  cout << endl;
+  theEventFlow.print(cout);
+  theMuonFlow.print(cout);
+  thePhaseTimer.print(cout);
 
-  int layercount[8]={0,0,0,0,0,0,0,0};
-  vector<int> stations;
-  edm::Handle<RPCRecHitCollection> rpcRecHits;
-  iEvent.getByToken(rpcRecHitToken_, rpcRecHits);
-
-  for(RPCRecHitCollection::const_iterator hitRPC = rpcRecHits->begin(); hitRPC != rpcRecHits->end(); hitRPC++) {
-    if ( !hitRPC->isValid()) continue;
-    
-    // only cound in-time RPC hits
-    if ( hitRPC->BunchX()!=0) continue;
-    RPCDetId myChamber((*hitRPC).geographicalId().rawId());
-    LocalPoint posLocalRPC = hitRPC->localPosition();
-
-    for(trackingRecHit_iterator hitC = muon->recHitsBegin(); hitC != muon->recHitsEnd(); ++hitC) {
-      if (!(*hitC)->isValid()) continue; 
-      if ( (*hitC)->geographicalId().det() != DetId::Muon ) continue; 
-      if ( (*hitC)->geographicalId().subdetId() != MuonSubdetId::RPC ) continue;
-
-      // Check that we're in the same RPC chamber
-      DetId id = (*hitC)->geographicalId();
-      RPCDetId rpcDetIdHit(id.rawId());
-      if (rpcDetIdHit!=myChamber) continue;
-
-      // Compare local positions of the muon hit and the hit being considered
-      LocalPoint posLocalMuon = (*hitC)->localPosition();
-      if((fabs(posLocalMuon.x()-posLocalRPC.x())<RPCCut)) 
-        layercount[(rpcDetIdHit.station()-1)*2+rpcDetIdHit.layer()-1]++;
-    }
+  if (theIndex) {
+    theIndex->close();
+    cout << " Event index written to " << theIndexOut << ": " << theIndex->size() << " candidates passing \""
+         << theIndexCuts.selection() << "\"" << endl;
   }
-  
-  stations.push_back(max(layercount[0],layercount[1]));
-  stations.push_back(max(layercount[2],layercount[3]));
-  stations.push_back(layercount[4]);
-  stations.push_back(layercount[6]);
-  
-  return stations;
 }
 
+// L1 candidates, DT/CSC segments and shower information of the event, for the muons with details
+void MuonNtupleFiller::loadDetails(const edm::Event& iEvent, const reco::MuonCollection& muonC) {
+  theDetailsLoaded = true;
+  iEvent.getByToken(muons_muonShowerInformation_token_, theShowers);
 
+  // Analyze L1 information
+  iEvent.getByToken(muCollToken_, theL1Muons);
+  const l1t::MuonBxCollection* muColl = theL1Muons.product();
+
+  // L1 candidates by index in the BX vector, and the muons competing for them
+  theL1Matcher.clear();
+  theL1BX.clear();
+  for (int ibx=muColl->getFirstBX(); ibx<=muColl->getLastBX(); ibx++)
+    for (auto it = muColl->begin(ibx); it != muColl->end(ibx); it++) {
+      theL1Matcher.add(distance(muColl->begin(muColl->getFirstBX()),it), it->eta(), it->phi());
+      theL1BX.push_back(ibx);
+    }
+  theLooseMuons.clear();
+  for (reco::MuonCollection::const_iterator imuon = muonC.begin(); imuon != muonC.end(); ++imuon)
+    if (imuon->pt()>thePtCut && muon::isLooseMuon(*imuon)) {
+      MuonCandidateMatcher::Direction dir = {(unsigned int)(imuon-muonC.begin()),
+                                             (float)imuon->tunePMuonBestTrack()->eta(),
+                                             (float)imuon->tunePMuonBestTrack()->phi()};
+      theLooseMuons.push_back(dir);
+    }
+  thePhaseTimer.mark(phL1);
 
-vector<int> MuonNtupleFiller::countDTsegs(const edm::Event& iEvent, reco::MuonRef muon) {
-  double DTCut = 25.;
-
-  std::vector<int> stations={0,0,0,0};
-
+  // DT and CSC segments of the event, once for all the muons
+  theHitCounter.clear();
+  theRPCHitsLoaded = false;
   edm::Handle<DTRecSegment4DCollection> dtSegments;
   iEvent.getByToken(dtSegmentToken_, dtSegments);
+  for (const auto &seg : *dtSegments) {
+    LocalPoint pos = seg.localPosition();
+    theHitCounter.addDTSegment(DTChamberId(seg.geographicalId().rawId()).rawId(), pos.x(), pos.y());
+  }
+  edm::Handle<CSCSegmentCollection> cscSegments;
+  iEvent.getByToken(cscSegmentToken_, cscSegments);
+  for (const auto &seg : *cscSegments) {
+    LocalPoint pos = seg.localPosition();
+    theHitCounter.addCSCSegment(CSCDetId(seg.geographicalId().rawId()).chamberId().rawId(), pos.x(), pos.y(), seg.nRecHits());
+  }
+  theHitCounter.build();
+  thePhaseTimer.mark(phSegments);
+}
 
-  for (const auto &ch : muon->matches()) {
-    if( ch.detector() != MuonSubdetId::DT )  continue;
-    DTChamberId DTid( ch.id.rawId() );
-
-    int nsegs_temp = 0;
-    std::vector<float> nsegs_x_temp, nsegs_y_temp;
-
-    for (auto seg = dtSegments->begin(); seg!=dtSegments->end(); ++seg) {
-      DTChamberId myChamber((*seg).geographicalId().rawId());
-      if (!(DTid==myChamber))  continue;
-      LocalPoint posLocalSeg = seg->localPosition();
-
-      if( ( posLocalSeg.x()!=0 && ch.x!=0 ) && (fabs(posLocalSeg.x()-ch.x)<DTCut) ) {
-        bool found = false;
-        for( auto prev_x : nsegs_x_temp) {
-          if( fabs(prev_x-posLocalSeg.x()) < 0.1 ) {
-            found = true;
-            break;
-          }
-        }
-        if( !found )  nsegs_x_temp.push_back(posLocalSeg.x());
-      }
-
-      if( ( posLocalSeg.y()!=0 && ch.y!=0 ) && (fabs(posLocalSeg.y()-ch.y)<DTCut) ) {
-        bool found = false;
-        for( auto prev_y : nsegs_y_temp) {
-          if( fabs(prev_y-posLocalSeg.y()) < 0.1 ) {
-            found = true;
-            break;
-          }
-        }
-        if( !found )  nsegs_y_temp.push_back(posLocalSeg.y());
-      }
+// input file of the index records
+void MuonNtupleFiller::respondToOpenInputFile(edm::FileBlock const& fb) {
+  if (theIndex) theIndexFile = theIndex->file(fb.fileName());
+}
 
-    }
+void MuonNtupleFiller::addToIndex(const edm::Event& iEvent, unsigned int imu, const reco::Muon& mu,
+                                  const MuonTimingCuts::MuonTimeInfo& times) {
+  EventIndexRecord record;
+  record.run = iEvent.id().run();
+  record.lumi = iEvent.luminosityBlock();
+  record.event = iEvent.id().event();
+  record.file = theIndexFile;
+  record.muon = imu;
+  record.pt = mu.pt();
+  record.eta = mu.eta();
+  record.phi = mu.phi();
+  record.cmbTime = times.cmbTime;
+  record.cmbTimeErr = times.cmbTimeErr;
+  record.cmbNdof = times.cmbNDof;
+  record.rpcTime = times.rpc.timeAtIpInOut;
+  record.rpcNdof = times.rpc.nDof;
+  theIndex->add(record);
+}
 
-    nsegs_temp = (int)std::max(nsegs_x_temp.size(), nsegs_y_temp.size());
+// tree baskets and the histograms in the output file
+void MuonNtupleFiller::reportMemory(const string& when) {
+  MemoryReport memory("MuonNtupleFiller");
+  memory.addTree(t);
+  memory.addHistograms(hFile);
+  cout << endl;
+  memory.print(cout, when);
+}
 
-    //--- subtract best matched segment from given muon
-    bool isBestMatched = false;
-    for(std::vector<reco::MuonSegmentMatch>::const_iterator matseg = ch.segmentMatches.begin(); matseg != ch.segmentMatches.end(); matseg++) {
-      if( matseg->isMask(reco::MuonSegmentMatch::BestInChamberByDR) ) {
-        isBestMatched = true;
-        break;
-      }
-    }
+double MuonNtupleFiller::iMass(reco::TrackRef imuon, reco::TrackRef iimuon) {
+  double energy1 = sqrt(imuon->p() * imuon->p() + 0.011163691);
+  double energy2 = sqrt(iimuon->p() * iimuon->p() + 0.011163691);
+  math::XYZTLorentzVector ip4(imuon->px(),imuon->py(),imuon->pz(),energy1);
+  math::XYZTLorentzVector iip4(iimuon->px(),iimuon->py(),iimuon->pz(),energy2);
+  math::XYZTLorentzVector psum = ip4+iip4;
+  double mmumu2 = psum.Dot(psum);
+  return sqrt(mmumu2);
+}
 
-    if(isBestMatched) nsegs_temp = nsegs_temp-1;
-    if(nsegs_temp>0)  stations[ch.station()-1] += nsegs_temp;
+vector<int> MuonNtupleFiller::countRPChits(reco::TrackRef muon, const edm::Event& iEvent) {
+  // the RPC hits of the event are added to the segments at the first call
+  if (!theRPCHitsLoaded) {
+    edm::Handle<RPCRecHitCollection> rpcRecHits;
+    iEvent.getByToken(rpcRecHitToken_, rpcRecHits);
+    for(RPCRecHitCollection::const_iterator hitRPC = rpcRecHits->begin(); hitRPC != rpcRecHits->end(); hitRPC++)
+      if (hitRPC->isValid())
+        theHitCounter.addRPCHit(hitRPC->geographicalId().rawId(), hitRPC->localPosition().x(), hitRPC->BunchX());
+    theHitCounter.build();
+    theRPCHitsLoaded = true;
+  }
 
+  theTrackHits.clear();
+  for(trackingRecHit_iterator hitC = muon->recHitsBegin(); hitC != muon->recHitsEnd(); ++hitC) {
+    if (!(*hitC)->isValid()) continue; 
+    if ( (*hitC)->geographicalId().det() != DetId::Muon ) continue; 
+    if ( (*hitC)->geographicalId().subdetId() != MuonSubdetId::RPC ) continue;
+    RPCDetId rpcDetIdHit((*hitC)->geographicalId().rawId());
+    MuonHitCounter::TrackHit hit = {rpcDetIdHit.rawId(), MuonHitCounter::RPC, rpcDetIdHit.station(), rpcDetIdHit.layer(),
+                                    (*hitC)->localPosition().x(), (*hitC)->localPosition().y()};
+    theTrackHits.push_back(hit);
   }
 
-  return stations;
+  int stations[4];
+  theHitCounter.countRPCHits(theTrackHits, stations);
+  return vector<int>(stations, stations+4);
 }
 
 
-vector<int> MuonNtupleFiller::countCSCsegs(const edm::Event& iEvent, reco::MuonRef muon) {
-  double CSCCut = 25.;
+// DT and CSC segments near the chambers crossed by the muon, besides the best matched one;
+// in the same pass the time and hits of the best segment of each station
+vector<int> MuonNtupleFiller::countSegments(const reco::Muon& muon, float muonTime) {
+  for (int i=0; i<4; i++)
+    dtSegTime[i] = dtSegRes[i] = dtSegHits[i] = cscSegTime[i] = cscSegRes[i] = cscSegHits[i] = noSegment;
 
-  std::vector<int> stations={0,0,0,0};
-
-  edm::Handle<CSCSegmentCollection> cscSegments;
-  iEvent.getByToken(cscSegmentToken_, cscSegments);  
-
-  for (const auto &ch : muon->matches()) {
-    if( ch.detector() != MuonSubdetId::CSC )  continue;
-    CSCDetId CSCid( ch.id.rawId() );
-
-    int nsegs_temp = 0;
-    std::vector<float> nsegs_phi_temp;
-    std::vector<float> nsegs_nhit_temp;
-
-    for (auto seg = cscSegments->begin(); seg!=cscSegments->end(); ++seg) {
-      CSCDetId myChamber((*seg).geographicalId().rawId());
-      if (!(CSCid==myChamber))  continue;
-      LocalPoint posLocalSeg = seg->localPosition();
-
-      if( (posLocalSeg.x()!=0 && posLocalSeg.y()!=0) && (sqrt( (posLocalSeg.x()-ch.x)*(posLocalSeg.x()-ch.x) + (posLocalSeg.y()-ch.y)*(posLocalSeg.y()-ch.y) )<CSCCut) )  { 
-        bool found = false;
-        for( auto prev_phi : nsegs_phi_temp) {
-          if( fabs(prev_phi-posLocalSeg.phi()) < 0.0002 ) {
-            for( auto prev_nhit2 : nsegs_nhit_temp) {
-              if( fabs(prev_nhit2-seg->nRecHits()) < 2 ) {
-                found = true;
-                break;
-              }
-            }
-          }
-        }
-        if( !found ) {
-          nsegs_phi_temp.push_back(posLocalSeg.phi());
-          nsegs_nhit_temp.push_back(seg->nRecHits());
-          nsegs_temp++;
-        }
-      }
-    }
+  theChamberMatches.clear();
+  for (const auto &ch : muon.matches()) {
+    if (ch.detector() != MuonSubdetId::DT && ch.detector() != MuonSubdetId::CSC) continue;
+    if (ch.station() < 1 || ch.station() > 4) continue;
+    bool isDT = ch.detector() == MuonSubdetId::DT;
+    float offset = theCalibration.offset(MuonChamberIndex::chamber(ch.id));
 
     //--- subtract best matched segment from given muon
     bool isBestMatched = false;
     for(std::vector<reco::MuonSegmentMatch>::const_iterator matseg = ch.segmentMatches.begin(); matseg != ch.segmentMatches.end(); matseg++) {
-      if( matseg->isMask(reco::MuonSegmentMatch::BestInChamberByDR) ) {
-        isBestMatched = true;
-        break;
+      if( matseg->isMask(reco::MuonSegmentMatch::BestInChamberByDR) ) isBestMatched = true;
+      if( !matseg->isMask(reco::MuonSegmentMatch::BestInStationByDR) ) continue;
+
+      // t0 of the DT phi segment / CSC segment time, both 0 for an in-time beta=1 muon, calibrated
+      if (isDT && !matseg->hasPhi()) continue;
+      int st = ch.station()-1, nHits = 0;
+      if (isDT && matseg->dtSegmentRef.isNonnull()) {
+        const DTRecSegment4D& seg = *matseg->dtSegmentRef;
+        if (seg.hasPhi()) nHits += seg.phiSegment()->specificRecHits().size();
+        if (seg.hasZed()) nHits += seg.zSegment()->specificRecHits().size();
       }
+      if (!isDT && matseg->cscSegmentRef.isNonnull()) nHits = matseg->cscSegmentRef->nRecHits();
+      short* time = isDT ? dtSegTime : cscSegTime;
+      short* res = isDT ? dtSegRes : cscSegRes;
+      short* hits = isDT ? dtSegHits : cscSegHits;
+      time[st] = packTime(matseg->t0 - offset);
+      res[st] = packTime(matseg->t0 - offset - muonTime);
+      hits[st] = nHits;
     }
 
-    if(isBestMatched) nsegs_temp = nsegs_temp-1;
-    if(nsegs_temp>0)  stations[ch.station()-1] += nsegs_temp;
+    unsigned int chamber = isDT ? DTChamberId(ch.id.rawId()).rawId()
+                                : CSCDetId(ch.id.rawId()).chamberId().rawId();
+    MuonHitCounter::ChamberMatch match = {chamber, ch.detector(), ch.station(), ch.x, ch.y, isBestMatched};
+    theChamberMatches.push_back(match);
   }
 
-  return stations;
+  int stations[4]={0,0,0,0};
+  theHitCounter.countDTSegments(theChamberMatches, stations);
+  theHitCounter.countCSCSegments(theChamberMatches, stations);
+  return vector<int>(stations, stations+4);
+}
+
+// ns -> int16 in 0.1 ns, saturating at +-3276.7 ns; noSegment if not a number (e.g. a bad t0)
+short MuonNtupleFiller::packTime(float time) {
+  if (!std::isfinite(time)) return noSegment;
+  float packed = roundf(time*10.f);
+  if (packed > 32767.f) return 32767;
+  if (packed < -32767.f) return -32767;
+  return (short)packed;
 }
 
 
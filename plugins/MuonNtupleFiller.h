@@ -13,6 +13,7 @@
 #include "FWCore/Framework/interface/EDAnalyzer.h"
 //#include "FWCore/Framework/interface/stream/EDProducer.h"
 #include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/FileBlock.h"
 
 #include "SimDataFormats/Track/interface/SimTrack.h"
 #include "SimDataFormats/Track/interface/SimTrackContainer.h"
@@ -37,6 +38,16 @@
 #include "DataFormats/L1Trigger/interface/Muon.h"
 #include "DataFormats/L1Trigger/interface/L1MuonParticle.h"
 #include "SimDataFormats/TrackingAnalysis/interface/TrackingParticle.h"
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+#include "UserCode/HSCPTOF/interface/CutFlow.h"
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
+#include "UserCode/HSCPTOF/interface/MuonCandidateMatcher.h"
+#include "UserCode/HSCPTOF/interface/PhaseTimer.h"
+#include "UserCode/HSCPTOF/interface/MemoryReport.h"
+#include "UserCode/HSCPTOF/interface/MuonTimingCuts.h"
+#include "UserCode/HSCPTOF/interface/EventIndex.h"
+#include "UserCode/HSCPTOF/interface/MuonTimeCalibration.h"
+#include "UserCode/HSCPTOF/interface/MuonChamberIndex.h"
 
 #include <TROOT.h>
 #include <TSystem.h>
@@ -69,11 +80,16 @@ private:
   virtual void beginJob() ;
   virtual void analyze(const edm::Event&, const edm::EventSetup&);
   virtual void endJob() ;
+  virtual void respondToOpenInputFile(edm::FileBlock const& fb);
 
   double iMass(reco::TrackRef imuon, reco::TrackRef iimuon);
   vector<int> countRPChits(reco::TrackRef muon, const edm::Event& iEvent);
-  vector<int> countDTsegs(const edm::Event& event, reco::MuonRef muon);
-  vector<int> countCSCsegs(const edm::Event& event, reco::MuonRef muon);
+  vector<int> countSegments(const reco::Muon& muon, float muonTime);
+  static short packTime(float time);
+  void reportMemory(const string& when);
+  void loadDetails(const edm::Event& iEvent, const reco::MuonCollection& muonC);
+  void addToIndex(const edm::Event& iEvent, unsigned int imu, const reco::Muon& mu,
+                  const MuonTimingCuts::MuonTimeInfo& times);
 
   // ----------member data ---------------------------
 
@@ -87,7 +103,47 @@ private:
   bool debug_;
   bool doSim;
   double theAngleCut;
+  CosmicPairTagger theCosmicTagger;
   double thePtCut;
+  // event and muon cut flows, stages in the order of the enums
+  enum { evAll, evBeamSpot, evMuons, evLeadingPt };
+  enum { muAll, muSTA, muPt };
+  CutFlow theEventFlow, theMuonFlow;
+  // time per event spent in each phase of analyze(), and the slowest events
+  enum { phFetch, phSelection, phTruth, phL1, phSegments, phFill };
+  PhaseTimer thePhaseTimer;
+  // memory footprint at beginJob/endJob and every theMemoryEvents events (0 = never)
+  bool theMemoryReport;
+  unsigned int theMemoryEvents;
+  unsigned long long theNEvents;
+
+  // DT/CSC segments (and RPC hits, on demand) of the event, sorted by chamber
+  MuonHitCounter theHitCounter;
+  bool theRPCHitsLoaded;
+  vector<MuonHitCounter::ChamberMatch> theChamberMatches;
+  vector<MuonHitCounter::TrackHit> theTrackHits;
+  // generated muons, TrackingParticle muons and L1 candidates of the event
+  MuonCandidateMatcher theGenMatcher, theTpMatcher, theL1Matcher;
+  vector<int> theL1BX;
+  vector<MuonCandidateMatcher::Direction> theLooseMuons;
+  vector<unsigned int> theL1Matches;
+
+  // sidecar index of the muons passing indexSelection (no index if empty), with their input file
+  MuonTimingCuts theIndexCuts;
+  string theIndexOut;
+  EventIndexWriter* theIndex;
+  uint32_t theIndexFile;
+
+  // segments, shower, L1 and truth variables only for the muons passing detailSelection (all if empty);
+  // the event collections they need are read for the first such muon
+  MuonTimingCuts theDetailCuts;
+  bool theDetails;
+  bool theDetailsLoaded;
+  edm::Handle<l1t::MuonBxCollection> theL1Muons;
+  edm::Handle<edm::ValueMap<reco::MuonShower> > theShowers;
+
+  // per-chamber time offsets by run range (timeCalibration file), subtracted from the segment times
+  MuonTimeCalibration theCalibration;
 
   edm::EDGetTokenT<reco::BeamSpot> beamSpotToken_;
   edm::EDGetTokenT<reco::TrackCollection> trackToken_;
@@ -132,6 +188,7 @@ private:
   int genBX;
 
   bool hasL1;
+  bool hasDetails;
   int l1Qual[10];
   float l1Pt[10], l1Phi[10], l1Eta[10];
   int l1BX[10];
@@ -163,6 +220,13 @@ private:
   int nrpchits[4];
   int nsegs[4];
   int nmatches[4];
+
+// best segment of each station (BestInStationByDR): time, time minus the muon time at the IP (the
+// residual to a beta=1 muon from the IP; the time itself if the muon has no time) in 0.1 ns, and its
+// hits; noSegment if the station has none, the muon has no details or the time is not finite
+  enum { noSegment = -32768 };
+  short dtSegTime[4], dtSegRes[4], dtSegHits[4];
+  short cscSegTime[4], cscSegRes[4], cscSegHits[4];
   
 // muon timing
   int muNdof;
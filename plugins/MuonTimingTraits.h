@@ -0,0 +1,106 @@
+#ifndef UserCode_HSCPTOF_MuonTimingTraits_H
+#define UserCode_HSCPTOF_MuonTimingTraits_H
+
+/** \class MuonTimingTraits
+ *  Muon types of the TimingAnalyzerT instantiations and their timing inputs.
+ *
+ *  RecoMuonTraits reads reco::Muon with the combined/DT/CSC MuonTimeExtra
+ *  ValueMaps and the general track collection (RECO/AOD). PatMuonTraits
+ *  reads pat::Muon, where only the combined time embedded in the muon
+ *  (Muon::time()) is available and the muon tracks have no TrackExtra (miniAOD).
+ *  timingHistograms selects the timing analysis proper (DT/CSC/combined time
+ *  histograms, timing cut scans, dimuons and tag-and-probe, refit, per-lumi
+ *  summaries); without it the analyzer fills the muon, RPC and Muon::time()
+ *  histograms of the original AODTimingAnalyzer.
+ *  MuonTimeExtraInputs<hasMaps> fetches the times of one muon; the version
+ *  without maps has no tokens at all, so nothing is read or checked per event.
+ */
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/ConsumesCollector.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+
+struct RecoMuonTraits {
+  typedef reco::Muon Muon;
+  typedef reco::MuonCollection MuonCollection;
+  // combined, DT and CSC MuonTimeExtra ValueMaps
+  static const bool timeExtraMaps = true;
+  // general tracks, for the collision veto
+  static const bool trackCollection = true;
+  // TrackExtras of the muon tracks (outer position, for the top/bottom leg)
+  static const bool trackExtras = true;
+  // DT/CSC/combined time histograms, cut scans, dimuons, refit and lumi summaries
+  static const bool timingHistograms = true;
+  // module name, for the printouts
+  static const char* name() { return "MuonTimingAnalyzer"; }
+};
+
+struct PatMuonTraits {
+  typedef pat::Muon Muon;
+  typedef pat::MuonCollection MuonCollection;
+  static const bool timeExtraMaps = false;
+  static const bool trackCollection = false;
+  static const bool trackExtras = false;
+  static const bool timingHistograms = false;
+  static const char* name() { return "AODTimingAnalyzer"; }
+};
+
+
+template <bool hasMaps> class MuonTimeExtraInputs;
+
+template <> class MuonTimeExtraInputs<true> {
+public:
+  void consume(edm::ConsumesCollector& collector, const edm::InputTag& timeTags) {
+    theCmbToken = collector.consumes<reco::MuonTimeExtraMap>(edm::InputTag(timeTags.label(),"combined"));
+    theDTToken = collector.consumes<reco::MuonTimeExtraMap>(edm::InputTag(timeTags.label(),"dt"));
+    theCSCToken = collector.consumes<reco::MuonTimeExtraMap>(edm::InputTag(timeTags.label(),"csc"));
+  }
+
+  void get(const edm::Event& iEvent) {
+    iEvent.getByToken(theCmbToken, theCmb);
+    iEvent.getByToken(theDTToken, theDT);
+    iEvent.getByToken(theCSCToken, theCSC);
+  }
+
+  /// times of muon i of the collection
+  template <class Collection>
+  void times(const edm::Handle<Collection>& muons, unsigned int i,
+             reco::MuonTimeExtra& cmb, reco::MuonTimeExtra& dt, reco::MuonTimeExtra& csc) const {
+    reco::MuonRef muonR(muons, i);
+    cmb = (*theCmb)[muonR];
+    dt = (*theDT)[muonR];
+    csc = (*theCSC)[muonR];
+  }
+
+private:
+  edm::EDGetTokenT<reco::MuonTimeExtraMap> theCmbToken, theDTToken, theCSCToken;
+  edm::Handle<reco::MuonTimeExtraMap> theCmb, theDT, theCSC;
+};
+
+template <> class MuonTimeExtraInputs<false> {
+public:
+  void consume(edm::ConsumesCollector&, const edm::InputTag&) {}
+  void get(const edm::Event&) {}
+
+  /// combined time at IP from Muon::time() (no inverse beta), empty DT and CSC times
+  template <class Collection>
+  void times(const edm::Handle<Collection>& muons, unsigned int i,
+             reco::MuonTimeExtra& cmb, reco::MuonTimeExtra& dt, reco::MuonTimeExtra& csc) const {
+    const reco::MuonTime& time = (*muons)[i].time();
+    cmb = reco::MuonTimeExtra();
+    cmb.setNDof(time.nDof);
+    cmb.setTimeAtIpInOut(time.timeAtIpInOut);
+    cmb.setTimeAtIpInOutErr(time.timeAtIpInOutErr);
+    cmb.setTimeAtIpOutIn(time.timeAtIpOutIn);
+    cmb.setTimeAtIpOutInErr(time.timeAtIpOutInErr);
+    dt = csc = reco::MuonTimeExtra();
+  }
+};
+
+#endif
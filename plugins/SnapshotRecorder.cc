@@ -0,0 +1,307 @@
+// -*- C++ -*-
+//
+// Package:    SnapshotRecorder
+// Class:      SnapshotRecorder
+//
+/**\class SnapshotRecorder SnapshotRecorder.cc
+
+ Description: Record compact event snapshots for offline replay
+
+ Implementation:
+     One EventSnapshot per event with at least minMuons muons, written to
+     the binary file "out". The collections other than the muons and their
+     times are optional: missing ones are left empty in the snapshot.
+*/
+
+#include "SnapshotRecorder.h"
+
+// system include files
+#include <cmath>
+#include <iostream>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+#include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
+#include "DataFormats/MuonDetId/interface/DTChamberId.h"
+#include "DataFormats/MuonDetId/interface/CSCDetId.h"
+#include "DataFormats/MuonDetId/interface/RPCDetId.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "UserCode/HSCPTOF/interface/MuonTimingCuts.h"
+
+//
+// constructors and destructor
+//
+SnapshotRecorder::SnapshotRecorder(const edm::ParameterSet& iConfig)
+  :
+  MuonTags_(iConfig.getUntrackedParameter<edm::InputTag>("Muons")),
+  TimeTags_(iConfig.getUntrackedParameter<edm::InputTag>("Timing")),
+  out(iConfig.getParameter<string>("out")),
+  theMinMuons(iConfig.getParameter<unsigned int>("minMuons")),
+  doSim(iConfig.getParameter<bool>("mctruthMatching")),
+  theWriter(0),
+  theNEvents(0)
+{
+  muonToken_ = consumes<reco::MuonCollection>(MuonTags_);
+  timeMapCmbToken_ = consumes<reco::MuonTimeExtraMap>(edm::InputTag(TimeTags_.label(),"combined"));
+  timeMapDTToken_ = consumes<reco::MuonTimeExtraMap>(edm::InputTag(TimeTags_.label(),"dt"));
+  timeMapCSCToken_ = consumes<reco::MuonTimeExtraMap>(edm::InputTag(TimeTags_.label(),"csc"));
+  vertexToken_ = consumes<reco::VertexCollection>(edm::InputTag("offlinePrimaryVertices"));
+  dtSegmentToken_ = consumes<DTRecSegment4DCollection>(edm::InputTag("dt4DSegments"));
+  cscSegmentToken_ = consumes<CSCSegmentCollection>(edm::InputTag("cscSegments"));
+  rpcRecHitToken_ = consumes<RPCRecHitCollection>(edm::InputTag("rpcRecHits"));
+  muCollToken_ = consumes<l1t::MuonBxCollection>(edm::InputTag("gmtStage2Digis","Muon"));
+  genParticleToken_ = consumes<GenParticleCollection>(edm::InputTag("genParticles"));
+  trackingParticleToken_ = consumes<TrackingParticleCollection>(edm::InputTag("mix","MergedTrackTruth"));
+}
+
+SnapshotRecorder::~SnapshotRecorder() {
+  delete theWriter;
+}
+
+//
+// member functions
+//
+
+// ------------ method called to for each event  ------------
+void
+SnapshotRecorder::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
+{
+  Handle<reco::MuonCollection> muons;
+  iEvent.getByToken(muonToken_, muons);
+  if (muons->size()<theMinMuons) return;
+
+  Handle<reco::MuonTimeExtraMap> timeMapCmb, timeMapDT, timeMapCSC;
+  iEvent.getByToken(timeMapCmbToken_, timeMapCmb);
+  iEvent.getByToken(timeMapDTToken_, timeMapDT);
+  iEvent.getByToken(timeMapCSCToken_, timeMapCSC);
+
+  Handle<reco::VertexCollection> vertices;
+  iEvent.getByToken(vertexToken_, vertices);
+
+  EventSnapshot& snap = theSnapshot;
+  snap.clear();
+  snap.run = iEvent.id().run();
+  snap.lumi = iEvent.luminosityBlock();
+  snap.event = iEvent.id().event();
+
+  const reco::Vertex* vtx = 0;
+  if (vertices.isValid()) {
+    for (const auto& v : *vertices) {
+      EventSnapshot::Vertex sv = {(float)v.x(), (float)v.y(), (float)v.z(), (float)v.ndof()};
+      snap.vertices.push_back(sv);
+    }
+    if (!vertices->empty()) vtx = &vertices->front();
+  }
+
+  // ---------------------------------------------------------------------------------------------
+  // ----------------------- muons ---------------------------------------------------------------
+  // ---------------------------------------------------------------------------------------------
+
+  const unsigned int nVariables = MuonTimingCuts::variableNames().size();
+  theChambers.clear();
+  theRolls.clear();
+
+  for (unsigned int i = 0; i < muons->size(); i++) {
+    const reco::Muon& mu = (*muons)[i];
+    reco::MuonRef muonR(muons, i);
+    const reco::MuonTimeExtra& cmb = (*timeMapCmb)[muonR];
+    const reco::MuonTimeExtra& dt = (*timeMapDT)[muonR];
+    const reco::MuonTimeExtra& csc = (*timeMapCSC)[muonR];
+    MuonTimingCuts::MuonTimeInfo times = MuonTimingCuts::timeInfo(mu, cmb, dt, csc);
+
+    // value-initialized, so the padding written to the file is zero
+    EventSnapshot::Muon smu = EventSnapshot::Muon();
+    smu.pt = mu.pt();
+    smu.eta = mu.eta();
+    smu.phi = mu.phi();
+    reco::TrackRef best = mu.tunePMuonBestTrack();
+    if (best.isNonnull()) {
+      smu.bestPt = best->pt();
+      smu.bestEta = best->eta();
+      smu.bestPhi = best->phi();
+      if (vtx) {
+        smu.dxy = best->dxy(vtx->position());
+        smu.dz = best->dz(vtx->position());
+      }
+    }
+    smu.charge = mu.charge();
+    reco::TrackRef trk = mu.track(), sta = mu.standAloneMuon(), glb = mu.combinedMuon();
+    smu.hasTrk = trk.isNonnull();
+    smu.hasSta = sta.isNonnull();
+    smu.hasGlb = glb.isNonnull();
+    if (smu.hasTrk) {
+      smu.trkPx = trk->px();
+      smu.trkPy = trk->py();
+      smu.trkPz = trk->pz();
+      smu.trkEta = trk->eta();
+      smu.trkPhi = trk->phi();
+    }
+    if (smu.hasSta) {
+      smu.staEta = sta->eta();
+      smu.staPhi = sta->phi();
+      smu.staPt = sta->pt();
+    }
+    if (smu.hasGlb) {
+      smu.glbPx = glb->px();
+      smu.glbPy = glb->py();
+      smu.glbPz = glb->pz();
+      smu.glbPt = glb->pt();
+      smu.glbCharge = glb->charge();
+    }
+    smu.isLoose = muon::isLooseMuon(mu);
+
+    smu.cmbNDof = times.cmbNDof;
+    smu.cmbTime = times.cmbTime;
+    smu.cmbTimeErr = times.cmbTimeErr;
+    smu.dtNDof = times.dtNDof;
+    smu.dtTime = times.dtTime;
+    smu.dtTimeErr = times.dtTimeErr;
+    smu.cscNDof = times.cscNDof;
+    smu.cscTime = times.cscTime;
+    smu.cscTimeErr = times.cscTimeErr;
+    smu.rpcNDof = times.rpc.nDof;
+    smu.rpcTime = times.rpc.timeAtIpInOut;
+    smu.rpcTimeErr = times.rpc.timeAtIpInOutErr;
+
+    for (unsigned int k = 0; k < nVariables; k++)
+      snap.variables.push_back(MuonTimingCuts::variable(k, mu, times, vtx));
+
+    // DT/CSC chambers crossed by the muon
+    smu.firstMatch = snap.matches.size();
+    for (const auto& ch : mu.matches()) {
+      if (ch.detector() != MuonSubdetId::DT && ch.detector() != MuonSubdetId::CSC) continue;
+      bool isBestMatched = false;
+      for (const auto& seg : ch.segmentMatches)
+        if (seg.isMask(reco::MuonSegmentMatch::BestInChamberByDR)) {
+          isBestMatched = true;
+          break;
+        }
+      unsigned int chamber = ch.detector() == MuonSubdetId::DT ? DTChamberId(ch.id.rawId()).rawId()
+                                                               : CSCDetId(ch.id.rawId()).chamberId().rawId();
+      MuonHitCounter::ChamberMatch match = MuonHitCounter::ChamberMatch();
+      match.chamber = chamber;
+      match.detector = ch.detector();
+      match.station = ch.station();
+      match.x = ch.x;
+      match.y = ch.y;
+      match.hasBestSegment = isBestMatched;
+      snap.matches.push_back(match);
+      theChambers.insert(chamber);
+    }
+    smu.nMatches = snap.matches.size() - smu.firstMatch;
+
+    // RPC hits of the standalone track (needs the TrackExtra, i.e. RECO)
+    smu.firstRPCHit = snap.rpcTrackHits.size();
+    if (smu.hasSta && sta->extra().isAvailable())
+      for (trackingRecHit_iterator hit = sta->recHitsBegin(); hit != sta->recHitsEnd(); ++hit) {
+        if (!(*hit)->isValid()) continue;
+        DetId id = (*hit)->geographicalId();
+        if (id.det() != DetId::Muon || id.subdetId() != MuonSubdetId::RPC) continue;
+        RPCDetId rpcId(id.rawId());
+        MuonHitCounter::TrackHit th = MuonHitCounter::TrackHit();
+        th.detId = rpcId.rawId();
+        th.detector = MuonHitCounter::RPC;
+        th.station = rpcId.station();
+        th.layer = rpcId.layer();
+        th.x = (*hit)->localPosition().x();
+        th.y = (*hit)->localPosition().y();
+        snap.rpcTrackHits.push_back(th);
+        theRolls.insert(th.detId);
+      }
+    smu.nRPCHits = snap.rpcTrackHits.size() - smu.firstRPCHit;
+
+    snap.muons.push_back(smu);
+  }
+
+  // ---------------------------------------------------------------------------------------------
+  // ----------------------- hits near the muons, L1 and truth -----------------------------------
+  // ---------------------------------------------------------------------------------------------
+
+  Handle<DTRecSegment4DCollection> dtSegments;
+  iEvent.getByToken(dtSegmentToken_, dtSegments);
+  if (dtSegments.isValid())
+    for (const auto& seg : *dtSegments) {
+      unsigned int chamber = DTChamberId(seg.geographicalId().rawId()).rawId();
+      if (!theChambers.count(chamber)) continue;
+      EventSnapshot::Segment s = {chamber, MuonHitCounter::DT, seg.localPosition().x(), seg.localPosition().y(), 0};
+      snap.segments.push_back(s);
+    }
+
+  Handle<CSCSegmentCollection> cscSegments;
+  iEvent.getByToken(cscSegmentToken_, cscSegments);
+  if (cscSegments.isValid())
+    for (const auto& seg : *cscSegments) {
+      unsigned int chamber = CSCDetId(seg.geographicalId().rawId()).chamberId().rawId();
+      if (!theChambers.count(chamber)) continue;
+      EventSnapshot::Segment s = {chamber, MuonHitCounter::CSC, seg.localPosition().x(), seg.localPosition().y(),
+                                  (int)seg.nRecHits()};
+      snap.segments.push_back(s);
+    }
+
+  Handle<RPCRecHitCollection> rpcRecHits;
+  iEvent.getByToken(rpcRecHitToken_, rpcRecHits);
+  if (rpcRecHits.isValid() && !theRolls.empty())
+    for (const auto& hit : *rpcRecHits) {
+      if (!hit.isValid() || !theRolls.count(hit.geographicalId().rawId())) continue;
+      EventSnapshot::RPCHit h = {hit.geographicalId().rawId(), hit.localPosition().x(), hit.BunchX()};
+      snap.rpcHits.push_back(h);
+    }
+
+  edm::Handle<l1t::MuonBxCollection> muColl;
+  iEvent.getByToken(muCollToken_, muColl);
+  if (muColl.isValid())
+    for (int ibx=muColl->getFirstBX(); ibx<=muColl->getLastBX(); ibx++)
+      for (auto it = muColl->begin(ibx); it != muColl->end(ibx); it++) {
+        EventSnapshot::Candidate c = {(float)it->pt(), (float)it->eta(), (float)it->phi(), it->hwQual(), ibx};
+        snap.l1.push_back(c);
+      }
+
+  if (doSim) {
+    Handle<GenParticleCollection> genParticles;
+    iEvent.getByToken(genParticleToken_, genParticles);
+    if (genParticles.isValid())
+      for (const auto& gen : *genParticles)
+        if (fabs(gen.pdgId())==13 && gen.p4().Pt()>2) {
+          EventSnapshot::Candidate c = {(float)gen.p4().Pt(), (float)gen.p4().eta(), (float)gen.p4().phi(), gen.pdgId(), 0};
+          snap.genMuons.push_back(c);
+        }
+  }
+
+  Handle<TrackingParticleCollection> trackingParticles;
+  iEvent.getByToken(trackingParticleToken_, trackingParticles);
+  if (trackingParticles.isValid())
+    for (const auto& tp : *trackingParticles)
+      if (fabs(tp.pdgId())==13 && tp.p4().Pt()>2) {
+        EventSnapshot::Candidate c = {(float)tp.p4().Pt(), (float)tp.p4().eta(), (float)tp.p4().phi(), tp.pdgId(),
+                                      tp.eventId().bunchCrossing()};
+        snap.tpMuons.push_back(c);
+      }
+
+  theWriter->write(snap);
+  theNEvents++;
+}
+
+
+void
+SnapshotRecorder::beginJob() {
+  theWriter = new EventSnapshotWriter(out, MuonTimingCuts::variableNames());
+}
+
+void
+SnapshotRecorder::endJob() {
+  cout << endl << " SnapshotRecorder: " << theNEvents << " events written to " << out
+       << " (" << theWriter->bytes()/1024 << " kB)" << endl;
+  delete theWriter;
+  theWriter = 0;
+}
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(SnapshotRecorder);
@@ -0,0 +1,79 @@
+#ifndef UserCode_HSCPTOF_SnapshotRecorder_H
+#define UserCode_HSCPTOF_SnapshotRecorder_H
+
+/** \class SnapshotRecorder
+ *  Writes what the HSCPTOF modules read from each event into an
+ *  EventSnapshot file, to be replayed with hscptofReplay.
+ *
+ *  Muons with their MuonTimeExtra and RPC times, chamber matches and RPC
+ *  hits, the MuonTimingCuts variables, the DT/CSC segments in the chambers
+ *  crossed by the muons, the RPC hits in the rolls of the muon RPC hits,
+ *  the L1 muon candidates, the vertices and the generated/TrackingParticle
+ *  muons (pt>2 GeV) when available.
+ */
+
+// Base Class Headers
+#include "FWCore/Framework/interface/EDAnalyzer.h"
+#include "FWCore/Framework/interface/Event.h"
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "DataFormats/RPCRecHit/interface/RPCRecHitCollection.h"
+#include "DataFormats/DTRecHit/interface/DTRecSegment4DCollection.h"
+#include "DataFormats/CSCRecHit/interface/CSCSegmentCollection.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/L1Trigger/interface/Muon.h"
+#include "SimDataFormats/TrackingAnalysis/interface/TrackingParticle.h"
+#include "UserCode/HSCPTOF/interface/EventSnapshot.h"
+
+#include <set>
+
+namespace edm {
+  class ParameterSet;
+  class EventSetup;
+  class InputTag;
+}
+
+using namespace std;
+using namespace edm;
+using namespace reco;
+
+class SnapshotRecorder : public edm::EDAnalyzer {
+public:
+  explicit SnapshotRecorder(const edm::ParameterSet&);
+  ~SnapshotRecorder();
+
+private:
+  virtual void beginJob() ;
+  virtual void analyze(const edm::Event&, const edm::EventSetup&);
+  virtual void endJob() ;
+
+  // ----------member data ---------------------------
+
+  edm::InputTag MuonTags_;
+  edm::InputTag TimeTags_;
+  string out;
+  unsigned int theMinMuons;
+  bool doSim;
+
+  edm::EDGetTokenT<reco::MuonCollection> muonToken_;
+  edm::EDGetTokenT<reco::MuonTimeExtraMap> timeMapCmbToken_;
+  edm::EDGetTokenT<reco::MuonTimeExtraMap> timeMapDTToken_;
+  edm::EDGetTokenT<reco::MuonTimeExtraMap> timeMapCSCToken_;
+  edm::EDGetTokenT<reco::VertexCollection> vertexToken_;
+  edm::EDGetTokenT<DTRecSegment4DCollection> dtSegmentToken_;
+  edm::EDGetTokenT<CSCSegmentCollection> cscSegmentToken_;
+  edm::EDGetTokenT<RPCRecHitCollection> rpcRecHitToken_;
+  edm::EDGetTokenT<l1t::MuonBxCollection> muCollToken_;
+  edm::EDGetTokenT<GenParticleCollection> genParticleToken_;
+  edm::EDGetTokenT<TrackingParticleCollection> trackingParticleToken_;
+
+  EventSnapshotWriter* theWriter;
+  // reused for every event
+  EventSnapshot theSnapshot;
+  set<unsigned int> theChambers, theRolls;
+  unsigned long long theNEvents;
+};
+#endif
@@ -0,0 +1,434 @@
+#ifndef UserCode_HSCPTOF_TimingAnalyzerT_H
+#define UserCode_HSCPTOF_TimingAnalyzerT_H
+
+/** \class TimingAnalyzerT
+ *  Analyzer of the timing information in the reco::Muon or pat::Muon object
+ *
+ *  Written once for both muon types, see MuonTimingTraits.h. The timing
+ *  histograms, the DT/CSC blocks and the collision veto are ordinary if
+ *  statements on the static const flags of the traits: compiled for both
+ *  instantiations, but never run (and normally optimized away) for the
+ *  traits without those inputs. Instantiated as MuonTimingAnalyzer
+ *  (reco::Muon) and AODTimingAnalyzer (pat::Muon).
+ *
+ *  $Date: 2011/04/06 09:56:30 $
+ *  $Revision: 1.4 $
+ *  \author P. Traczyk    CERN
+ */
+
+// Base Class Headers
+#include "FWCore/Framework/interface/EDAnalyzer.h"
+//#include "FWCore/Framework/interface/stream/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/FileBlock.h"
+
+#include "SimDataFormats/Track/interface/SimTrack.h"
+#include "SimDataFormats/Track/interface/SimTrackContainer.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "DataFormats/TrackReco/interface/TrackExtraFwd.h"
+#include "DataFormats/TrackReco/interface/TrackToTrackMap.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
+#include "RecoMuon/TrackingTools/interface/MuonSegmentMatcher.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+#include "DataFormats/DTRecHit/interface/DTRecSegment4DCollection.h"
+#include "DataFormats/DTRecHit/interface/DTRecHitCollection.h"
+#include "DataFormats/CSCRecHit/interface/CSCSegmentCollection.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/L1Trigger/interface/Muon.h"
+#include "SimDataFormats/TrackingAnalysis/interface/TrackingParticle.h"
+#include "UserCode/HSCPTOF/interface/SparseHist2D.h"
+#include "UserCode/HSCPTOF/interface/HistSnapshotWriter.h"
+#include "UserCode/HSCPTOF/interface/TimingStats.h"
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+#include "UserCode/HSCPTOF/interface/MuonTimingCuts.h"
+#include "UserCode/HSCPTOF/interface/CutFlow.h"
+#include "UserCode/HSCPTOF/interface/DimuonPairBuilder.h"
+#include "UserCode/HSCPTOF/interface/TimingFitter.h"
+#include "UserCode/HSCPTOF/interface/MuonGeometryCache.h"
+#include "UserCode/HSCPTOF/interface/MuonTimeCalibration.h"
+#include "UserCode/HSCPTOF/interface/ChamberTimeMonitor.h"
+#include "UserCode/HSCPTOF/interface/TimingCellStats.h"
+#include "UserCode/HSCPTOF/interface/MuonCandidateMatcher.h"
+#include "UserCode/HSCPTOF/interface/TimingCutScan.h"
+#include "UserCode/HSCPTOF/interface/PhaseTimer.h"
+#include "UserCode/HSCPTOF/interface/MemoryReport.h"
+#include "UserCode/HSCPTOF/interface/EventIndex.h"
+#include "MuonTimingTraits.h"
+
+#include <TROOT.h>
+#include <TSystem.h>
+
+#include <map>
+
+namespace edm {
+  class ParameterSet;
+  class EventSetup;
+  class InputTag;
+}
+
+class TFile;
+class TH1;
+class TH1F;
+class TH2F;
+
+using namespace std;
+using namespace edm;
+using namespace reco;
+
+template <class Traits>
+class TimingAnalyzerT : public edm::EDAnalyzer {
+public: 
+  typedef typename Traits::MuonCollection MuonCollection;
+
+  explicit TimingAnalyzerT(const edm::ParameterSet&);
+  ~TimingAnalyzerT();
+  
+private:
+  virtual void beginJob() ;
+  virtual void analyze(const edm::Event&, const edm::EventSetup&);
+  virtual void endJob() ;
+  virtual void respondToOpenInputFile(edm::FileBlock const& fb);
+
+  TimingFitResult refitTiming(const reco::Muon& muon);
+  void monitorChambers(const reco::Muon& muon);
+  void pairCosmicLegs(const MuonCollection& muonC);
+  void writeChamberMonitor();
+  int etaPhiCell(double eta, double phi) const;
+  void writeTimingStats();
+  void fillDimuons(const MuonCollection& muonC, const vector<bool>& selected,
+                   const reco::Vertex& vtx, const vector<reco::MuonTimeExtra>& cmbTimes);
+  bool dumpMuonId(const reco::Muon& muon, const reco::Vertex& vtx, const bool debug);
+  void dumpTrack(reco::TrackRef track);
+  static void copyCutScan(const TimingCutScan& scan, TH1* h);
+  static const vector<string>& cutVariables();
+  void fillCutScans();
+  void takeSnapshot();
+  void writeLumiSummaries();
+  void reportMemory(const string& when);
+  void addToIndex(const edm::Event& iEvent, unsigned int imu, const reco::Muon& mu,
+                  const MuonTimingCuts::MuonTimeInfo& times);
+
+  // ----------member data ---------------------------
+
+  edm::ConsumesCollector *iC;
+  edm::InputTag TKtrackTags_; 
+  edm::InputTag MuonTags_; 
+  edm::InputTag VtxTags_; 
+  edm::InputTag TimeTags_; 
+  edm::InputTag SIMtrackTags_; 
+
+  string out, open;
+  bool theDebug;
+  bool doSim;
+  string theIdCut;
+  bool theCollVeto;
+  bool theKeepBX;
+  int theBX;
+  bool theVetoCosmics;
+  bool theOnlyCosmics;
+  double theAngleCut, theAngleWindow;
+  // back-to-back pair finders on tracker and global track directions, within angleWindowWide
+  CosmicPairTagger theTrkTagger, theGlbTagger;
+  // top/bottom legs of cosmic muons among the selected muons, paired by direction (muon best track)
+  struct CosmicLeg {
+    int leg;                      // +1 top, -1 bottom (y of the outermost standalone hit), 0 none
+    bool hasDtTime, paired;
+    double dtTime, phi, glbPt, staPt;   // pt 0 without the track
+  };
+  vector<CosmicLeg> theLegs;
+  CosmicPairTagger theLegTagger;
+  vector<CosmicPairTagger::Pair> theLegPairs;
+  double  theMinEta, theMaxEta, thePtCut, theMinPtres, theMaxPtres, theScale;
+  int theDtCut, theCscCut;
+  int theNBins;
+  // PtCut, eta window and requireId
+  MuonTimingCuts theMuonCuts;
+  // event and muon cut flows, stages in the order of the enums
+  enum { evAll, evBeamSpot, evCollVeto, evMuons, evCosmicVeto, evOnlyCosmics };
+  enum { muAll, muKinematics, muId, muCosmicIP, muTruth };
+  CutFlow theEventFlow, theMuonFlow;
+  double theTpTagPt, theTpProbePt, theTpMassMin, theTpMassMax, theTpTimeWindow;
+  bool theRefit;
+  double theRefitDTError, theRefitCSCError;
+  bool theSparseAsTHn;
+  string theSnapshotOut;
+  unsigned int theSnapshotEvents;
+  double theSnapshotSeconds;
+  bool theLumiSummary;
+  // time per event spent in each phase of analyze(), and the slowest events
+  enum { phFetch, phTruth, phCosmic, phSelection, phHistograms, phRefit, phDimuons };
+  PhaseTimer thePhaseTimer;
+  // memory footprint at beginJob/endJob and every theMemoryEvents events (0 = never)
+  bool theMemoryReport;
+  unsigned int theMemoryEvents;
+  unsigned long long theNEvents;
+
+  edm::EDGetTokenT<reco::BeamSpot> beamSpotToken_;
+  edm::EDGetTokenT<reco::TrackCollection> trackToken_;
+  edm::EDGetTokenT<MuonCollection> muonToken_;
+  edm::EDGetTokenT<reco::VertexCollection> vertexToken_;
+  edm::EDGetTokenT<GenParticleCollection> genParticleToken_;
+  edm::EDGetTokenT<TrackingParticleCollection> trackingParticleToken_;
+  // combined/DT/CSC times, from the ValueMaps or from the muon
+  MuonTimeExtraInputs<Traits::timeExtraMaps> theTimeInputs;
+
+  Handle<MuonCollection> MuCollection;
+  Handle<reco::TrackCollection> TKTrackCollection;
+  Handle<reco::TrackCollection> STATrackCollection;
+  Handle<reco::TrackCollection> GLBTrackCollection;
+  Handle<reco::TrackCollection> PMRTrackCollection;
+  Handle<reco::TrackCollection> GMRTrackCollection;
+  Handle<reco::TrackCollection> FMSTrackCollection;
+  Handle<reco::TrackCollection> SLOTrackCollection;
+  Handle<edm::SimTrackContainer> SIMTrackCollection;
+  
+  //ROOT Pointers
+  TFile* hFile;
+  TStyle* effStyle;
+
+  // large, mostly empty 2D histograms kept in sparse form until endJob
+  vector<SparseHist2D*> theSparseHists;
+
+  // periodic snapshots of the histograms, written by a background thread
+  HistSnapshotWriter* theSnapshots;
+
+  // time-at-vertex summaries per (run, lumi), keyed by the event itself so interleaved lumis are fine
+  map<pair<unsigned int,unsigned int>, TimingSummary> theLumiSummaries;
+  pair<unsigned int,unsigned int> theCurrentLumiKey;
+  TimingSummary* theCurrentLumi;
+
+  // dimuon pairs of global and standalone tracks
+  DimuonPairBuilder theGlbPairs, theStaPairs;
+
+  // timing refit from the matched DT/CSC segments
+  TimingFitter theTimingFitter;
+
+  // DT/CSC chamber transforms, per geometry IOV
+  MuonGeometryCache theGeometry;
+
+  // per-chamber time offsets by run range (timeCalibration file), subtracted from the refit segment times
+  MuonTimeCalibration theCalibration;
+
+  // segment times per chamber of the selected muons, in one [chamber][time bin] array (0 if chamberMonitor is off)
+  ChamberTimeMonitor* theChamberMonitor;
+
+  // moments and quantile sketches of the segment time per chamber and of the combined time at vertex
+  // per eta/phi cell (0 if timingStats is off), written as tables mergeable with hscptofStats
+  TimingCellStats* theChamberStats;
+  TimingCellStats* theEtaPhiStats;
+  unsigned int theStatsEtaBins, theStatsPhiBins;
+
+  // generated muons (TrackingParticles) of the event for the truth matching
+  MuonCandidateMatcher theTruthMatcher;
+
+  // rejected muons vs time cut (and nDof cut), copied to the hi_id_*cut_* histograms
+  TimingCutScan theRpcScanSta, theRpcScanGlb, theCscScanSta, theCscScanGlb;
+  TimingCutScan theDtScanSta, theDtScanGlb, theCmbScanSta, theCmbScanGlb;
+
+  // sidecar index of the muons passing indexSelection (no index if empty), with their input file
+  MuonTimingCuts theIndexCuts;
+  string theIndexOut;
+  EventIndexWriter* theIndex;
+  uint32_t theIndexFile;
+
+  TH1F* hi_gen_pt;
+  TH1F* hi_gen_eta;
+  TH1F* hi_gen_phi;
+
+  TH1F* hi_id_rpccut_sta;
+  TH1F* hi_id_rpccut_glb;
+  TH1F* hi_id_csccut_sta;
+  TH1F* hi_id_csccut_glb;
+  TH2F* hi_id_dtcut_sta;
+  TH2F* hi_id_dtcut_glb;
+  TH2F* hi_id_cmbcut_sta;
+  TH2F* hi_id_cmbcut_glb;
+
+  TH1F* hi_id_trklay;
+  TH1F* hi_id_trkhit;
+  TH1F* hi_id_statio;
+  TH1F* hi_id_dxy;
+  TH1F* hi_id_dz;
+
+  TH1F* hi_glb_mass_ss  ;
+  TH1F* hi_glb_mass_os  ;
+  TH1F* hi_sta_mass_ss  ;
+  TH1F* hi_sta_mass_os  ;
+
+  TH1F* hi_tp_mass;
+  TH1F* hi_tp_probe_pt;
+  TH1F* hi_tp_probe_eta;
+  TH1F* hi_tp_time_pt;
+  TH1F* hi_tp_time_eta;
+  TH1F* hi_tp_intime_pt;
+  TH1F* hi_tp_intime_eta;
+
+  TH1F* hi_glb_angle;
+  TH1F* hi_trk_angle;
+  TH1F* hi_glb_angle_w;
+  TH1F* hi_trk_angle_w;
+  TH2F* hi_dttime_vtx_tb_angle;
+
+  TH1F* hi_sta_pt  ;
+  TH1F* hi_sta_pt_cut;  
+  TH1F* hi_sta_ptres  ;
+  TH1F* hi_sta_ptg  ;
+  TH1F* hi_sta_ptt  ;
+  TH1F* hi_sta_ptres_tb  ;
+  TH1F* hi_tk_pt   ;
+  TH1F* hi_glb_pt  ;
+  TH1F* hi_glb_pt_cut  ;
+  TH1F* hi_glb_ptg  ;
+  TH1F* hi_glb_ptt  ;
+  TH1F* hi_glb_ptres  ;
+  TH1F* hi_glb_ptresh ;
+  TH1F* hi_glb_ptres_t  ;
+  TH1F* hi_glb_ptresh_t ;
+  TH1F* hi_glb_ptres_b  ;
+  TH1F* hi_glb_ptresh_b ;
+  TH1F* hi_glb_ptres_tb  ;
+  TH1F* hi_glb_d0  ;
+  TH1F* hi_sta_phi ;
+  TH1F* hi_tk_phi  ;
+  TH1F* hi_glb_phi ;
+  TH1F* hi_sta_nhits ;
+  TH1F* hi_tk_nhits  ;
+  TH1F* hi_glb_nhits ;
+  TH1F* hi_sta_nvhits ;
+  TH1F* hi_tk_nvhits  ;
+  TH1F* hi_glb_nvhits ;
+  TH1F* hi_sta_chi2 ;
+  TH1F* hi_tk_chi2  ;
+  TH1F* hi_glb_chi2 ;
+  TH1F* hi_tk_eta  ;
+  TH1F* hi_sta_eta  ;
+  TH1F* hi_glb_eta  ;
+
+  TH1F* hi_mutime_ndof;
+  TH1F* hi_mutime_vtx;
+  TH1F* hi_mutime_vtx_err;
+
+  TH1F* hi_dtcsc_vtx;
+  TH1F* hi_dtcsc_vtx_t;
+  TH1F* hi_dtcsc_vtx_b;
+
+  TH2F* hi_dtrpc_vtx;
+  TH2F* hi_cscrpc_vtx;
+  TH2F* hi_cmbrpc_vtx;
+  TH2F* hi_dtrpc3_vtx;
+  TH2F* hi_cscrpc3_vtx;
+  TH2F* hi_cmbrpc3_vtx;
+  SparseHist2D* hi_dtrpc3_vtxw;
+  SparseHist2D* hi_cscrpc3_vtxw;
+  SparseHist2D* hi_cmbrpc3_vtxw;
+
+  TH1F* hi_trpc;
+  TH1F* hi_trpc3;
+  TH1F* hi_trpcerr;
+  TH1F* hi_nrpc;
+  TH2F* hi_nrpc_trpc;
+  TH2F* hi_trpc_eta;
+  TH2F* hi_trpc_phi;
+
+  TH1F* hi_cmbtime_ibt;
+  TH2F* hi_cmbtime_ibt_pt;
+  TH1F* hi_cmbtime_ibt_err;
+  TH1F* hi_cmbtime_ibt_pull;
+  TH1F* hi_cmbtime_fib;
+  TH1F* hi_cmbtime_fib_err;
+  TH1F* hi_cmbtime_fib_pull;
+  TH1F* hi_cmbtime_vtx;
+  TH2F* hi_cmbtime_vtxn;
+  TH1F* hi_cmbtime_vtxw;
+  TH1F* hi_cmbtime_vtx_err;
+  TH1F* hi_cmbtime_vtx_pull;
+  TH1F* hi_cmbtime_vtxr;
+  TH1F* hi_cmbtime_vtxr_err;
+  TH1F* hi_cmbtime_vtxr_pull;
+  TH1F* hi_cmbtime_ndof;
+
+  TH1F* hi_dttime_ibt;
+  TH2F* hi_dttime_ibt_pt;
+  TH1F* hi_dttime_ibt_err;
+  TH1F* hi_dttime_ibt_pull;
+  TH1F* hi_dttime_fib;
+  TH1F* hi_dttime_fib_t;
+  TH1F* hi_dttime_fib_b;
+  TH2F* hi_dttime_fibp_t;
+  TH2F* hi_dttime_fibp_b;
+  TH1F* hi_dttime_fib_err;
+  TH1F* hi_dttime_fib_pull;
+  TH1F* hi_dttime_vtx;
+  TH2F* hi_dttime_vtxn;
+  TH1F* hi_dttime_vtxw;
+  SparseHist2D* hi_dttime_vtx_pt;
+  SparseHist2D* hi_dttime_vtx_phi;
+  SparseHist2D* hi_dttime_vtx_eta;
+  TH2F* hi_dttime_etaphi;
+  TH2F* hi_dttime_eeta_lo;
+  TH2F* hi_dttime_eeta_hi;
+  TH2F* hi_dttime_vtx_etat;
+  TH2F* hi_dttime_vtx_etab;
+  TH1F* hi_dttime_vtx_t;
+  TH1F* hi_dttime_vtx_b;
+  TH1F* hi_dttime_vtx_to;
+  TH1F* hi_dttime_vtx_bo;
+  TH1F* hi_dttime_vtx_tb;
+  TH2F* hi_dttime_vtx_tb2;
+  TH2F* hi_dttime_vtxp_t;
+  TH2F* hi_dttime_vtxp_b;
+  TH2F* hi_dttime_vtxp_tb;
+  TH2F* hi_dttime_vtxpt_tb;
+  TH1F* hi_dttime_vtx_err;
+  TH1F* hi_dttime_vtx_pull;
+  TH1F* hi_dttime_vtxr;
+  TH1F* hi_dttime_vtxr_err;
+  TH1F* hi_dttime_vtxr_pull;
+  TH1F* hi_dttime_errdiff;
+  TH1F* hi_dttime_errdiff_t;
+  TH1F* hi_dttime_errdiff_b;
+  TH1F* hi_dttime_ndof;
+
+  TH1F* hi_csctime_ibt;
+  TH2F* hi_csctime_ibt_pt;
+  TH1F* hi_csctime_ibt_err;
+  TH1F* hi_csctime_ibt_pull;
+  TH1F* hi_csctime_fib;
+  TH1F* hi_csctime_fib_err;
+  TH1F* hi_csctime_fib_pull;
+  TH1F* hi_csctime_vtx;
+  TH1F* hi_csctime_vtx_err;
+  TH1F* hi_csctime_vtx_pull;
+  SparseHist2D* hi_csctime_vtx_pt;
+  SparseHist2D* hi_csctime_vtx_eta;
+  SparseHist2D* hi_csctime_vtx_phi;
+  TH2F* hi_csctime_vtxn;
+  TH1F* hi_csctime_vtxr;
+  TH1F* hi_csctime_vtxr_err;
+  TH1F* hi_csctime_vtxr_pull;
+  TH1F* hi_csctime_ndof;
+
+  TH1F* hi_refit_ndof;
+  TH1F* hi_refit_ibt;
+  TH1F* hi_refit_ibt_err;
+  TH1F* hi_refit_fib;
+  TH1F* hi_refit_vtx;
+  TH1F* hi_refit_vtx_err;
+  TH1F* hi_refit_vtxr;
+  TH1F* hi_refit_ibt_diff;
+  TH1F* hi_refit_vtx_diff;
+  TH2F* hi_csctime_eeta_lo;
+  TH2F* hi_csctime_eeta_hi;
+
+};
+
+#include "TimingAnalyzerT.icc"
+
+#endif
@@ -12,6 +12,7 @@ aodTimingAnalyzer = cms.EDAnalyzer("AODTimingAnalyzer",
     PrimaryVertex = cms.untracked.InputTag("offlineSlimmedPrimaryVertices"),
 
 # Event-level cuts
+    # (no general track collection in miniAOD, collisionVeto is not applied)
     collisionVeto = cms.bool(False),
     keepOnlyBX = cms.bool(False),
     generatedBX = cms.int32(0),
@@ -19,8 +20,16 @@ aodTimingAnalyzer = cms.EDAnalyzer("AODTimingAnalyzer",
     onlyCosmics = cms.bool(False),
     # cosmic ID back-to-back angle cut 
     angleCut = cms.double(0.02),
+    # back-to-back pairs within this angle fill the opening angle histograms and pair the cosmic legs
+    angleWindow = cms.double(0.1),
+    # and within this one the wide opening angle histograms (hi_*_angle_w, axis up to this angle);
+    # the wider it is, the more pairs have to be checked; 3.2 for the full range (every pair)
+    angleWindowWide = cms.double(0.5),
 
 # Muon-level cuts
+    # "glb", "loose", "tight", "norpc", "norpc3", "timeok", or a cut expression on the
+    # muon variables (see MuonTimingCuts.cc), e.g. "isLoose && rpcNdof<=1 && abs(cmbTime)<20"
+    # (only the combined time is stored in pat::Muon, the dt*/csc* variables are rejected)
     requireId = cms.string(""),
     PtCut = cms.double(5.0),
     etaMin = cms.double(0.0),
@@ -28,11 +37,47 @@ aodTimingAnalyzer = cms.EDAnalyzer("AODTimingAnalyzer",
     DTcut  = cms.int32(6),
     CSCcut = cms.int32(4),
 
+# Per-chamber time offsets subtracted from the segment times of the chamber monitor and timing stats, by run range
+# (format in interface/MuonTimeCalibration.h); "" = no correction
+    timeCalibration = cms.string(''),
+# Segment time of every DT/CSC chamber in one array, written as chambers/hi_chamber_time (chamber index
+# vs time) and the chambers/chamberSummary tree; the chambers with the largest mean time are printed
+    chamberMonitor = cms.bool(False),
+    chamberTimeBins = cms.uint32(100),
+    chamberTimeMin = cms.double(-50.),
+    chamberTimeMax = cms.double(50.),
+# Mean, RMS and 16/50/84% quantiles (Welford moments and a KLL sketch of size ~3*timingStatsK) of the
+# segment time per chamber and of the combined time at vertex per eta/phi cell (|eta|<2.4), written as
+# the stats/chamberTimeStats and stats/etaPhiTimeStats tables; merge jobs with hscptofStats
+    timingStats = cms.bool(False),
+    timingStatsK = cms.uint32(200),
+    timingStatsEtaBins = cms.uint32(24),
+    timingStatsPhiBins = cms.uint32(36),
+
 # Output plot parameters
     PtresMax = cms.double(400.0),
     PtresMin = cms.double(0.0),
     PlotScale = cms.double(1.0),
     nbins = cms.int32(100),
+    # periodic snapshot of the histograms every N events and/or N seconds (0 = off)
+    snapshotEvents = cms.uint32(0),
+    snapshotSeconds = cms.double(0.),
+    snapshotOut = cms.string('aodTimingAnalyzer_snapshot.root'),
+    # time per phase of analyze() (histograms in timing/) and the slowest events, printed at the end
+    phaseTiming = cms.bool(False),
+    slowEvents = cms.uint32(10),
+    # also cycles, instructions, LLC and branch misses per phase (perf_event_open; thread CPU time
+    # if the counters are not accessible, e.g. with kernel.perf_event_paranoid>2)
+    phaseCounters = cms.bool(False),
+    # memory per histogram group, tree baskets and process RSS/high-water mark at beginJob, endJob
+    # and every memoryReportEvents events (0 = only at beginJob/endJob)
+    memoryReport = cms.bool(False),
+    memoryReportEvents = cms.uint32(0),
+    # sidecar index (run, lumi, event, input file, muon summary) of the muons passing this
+    # requireId-style expression, e.g. "pt>100 && cmbNdof>7 && abs(cmbTime)>15"; "" = no index.
+    # Look the events up with hscptofIndex.
+    indexSelection = cms.string(""),
+    indexOut = cms.string('aodTimingAnalyzerIndex.bin'),
     open = cms.string('recreate'),
     out = cms.string('aodTimingAnalyzer.root'),
     debug= cms.bool(False)
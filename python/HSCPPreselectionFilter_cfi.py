@@ -0,0 +1,18 @@
+import FWCore.ParameterSet.Config as cms
+
+hscpPreselectionFilter = cms.EDFilter("HSCPPreselectionFilter",
+
+# reco::Muon or pat::Muon collection
+    Muons = cms.untracked.InputTag("muons"),
+
+# Muon-level cuts, same meaning as in MuonTimingAnalyzer/AODTimingAnalyzer
+# (isTight is applied without the vertex cuts; only the combined time from the muon
+# is available, an expression using the dt*/csc* variables is rejected)
+    requireId = cms.string(""),
+    PtCut = cms.double(5.0),
+    etaMin = cms.double(0.0),
+    etaMax = cms.double(2.5),
+
+# events are kept with at least this many muons passing the cuts
+    minMuons = cms.uint32(1)
+)
@@ -12,6 +12,29 @@ muonNtupleFiller = cms.EDAnalyzer("MuonNtupleFiller",
     angleCut = cms.double(0.02),
     PtCut = cms.double(30.0),
 
+    # time per phase of analyze() (histograms in timing/) and the slowest events, printed at the end
+    phaseTiming = cms.bool(False),
+    slowEvents = cms.uint32(10),
+    # also cycles, instructions, LLC and branch misses per phase (perf_event_open; thread CPU time
+    # if the counters are not accessible, e.g. with kernel.perf_event_paranoid>2)
+    phaseCounters = cms.bool(False),
+    # memory per histogram group, tree baskets and process RSS/high-water mark at beginJob, endJob
+    # and every memoryReportEvents events (0 = only at beginJob/endJob)
+    memoryReport = cms.bool(False),
+    memoryReportEvents = cms.uint32(0),
+    # sidecar index (run, lumi, event, input file, muon summary) of the muons passing this
+    # requireId-style expression, e.g. "pt>100 && cmbNdof>7 && abs(cmbTime)>15"; "" = no index.
+    # Look the events up with hscptofIndex.
+    indexSelection = cms.string(""),
+    indexOut = cms.string('muonNtupleFillerIndex.bin'),
+    # compute the segment counts, shower hits, L1 and truth matching only for the muons passing this
+    # requireId-style expression on the cheap variables, e.g. "pt>200 || abs(cmbTime)>10";
+    # hasDetails tells which rows have them. "" = for every muon.
+    detailSelection = cms.string(""),
+    # per-chamber time offsets subtracted from the dtSegTime/cscSegTime columns, by run range
+    # (format in interface/MuonTimeCalibration.h); "" = no correction
+    timeCalibration = cms.string(''),
+
     open = cms.string('recreate'),
     out = cms.string('muonNtuple.root'),
     debug= cms.bool(False)
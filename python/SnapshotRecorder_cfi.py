@@ -0,0 +1,16 @@
+import FWCore.ParameterSet.Config as cms
+
+snapshotRecorder = cms.EDAnalyzer("SnapshotRecorder",
+
+    Muons = cms.untracked.InputTag("muons"),
+    Timing = cms.untracked.InputTag("muons"),
+
+# generated muons (genParticles) are recorded only if set; TrackingParticles whenever present
+    mctruthMatching = cms.bool(False),
+
+# events with fewer muons are not written
+    minMuons = cms.uint32(1),
+
+# binary EventSnapshot file, read by hscptofReplay
+    out = cms.string('hscptofSnapshots.bin')
+)
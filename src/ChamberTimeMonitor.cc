@@ -0,0 +1,111 @@
+#include "UserCode/HSCPTOF/interface/ChamberTimeMonitor.h"
+#include "UserCode/HSCPTOF/interface/MuonChamberIndex.h"
+
+#include <TH2F.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+ChamberTimeMonitor::ChamberTimeMonitor(unsigned int nBins, float tMin, float tMax)
+  : theNBins(nBins),
+    theStride(nBins + 2),
+    theMin(tMin),
+    theMax(tMax),
+    theScale(tMax > tMin ? nBins / (tMax - tMin) : 0.f),
+    theCounts((size_t)MuonChamberIndex::nChambers * (nBins + 2), 0)
+{
+  if (!nBins || tMax <= tMin) throw invalid_argument("ChamberTimeMonitor: empty time range");
+}
+
+void ChamberTimeMonitor::merge(const ChamberTimeMonitor& other) {
+  if (other.theNBins != theNBins || other.theMin != theMin || other.theMax != theMax)
+    throw invalid_argument("ChamberTimeMonitor: merging different binnings");
+  for (size_t i = 0; i < theCounts.size(); i++) theCounts[i] += other.theCounts[i];
+}
+
+ChamberTimeMonitor::Summary ChamberTimeMonitor::summary(int chamber) const {
+  const unsigned int* row = &theCounts[chamber * theStride];
+  Summary s;
+  s.underflow = row[0];
+  s.overflow = row[theNBins + 1];
+  s.entries = s.underflow + s.overflow;
+  s.mean = s.rms = s.median = 0;
+
+  const float width = (theMax - theMin) / theNBins;
+  double n = 0, sum = 0, sum2 = 0;
+  for (unsigned int ib = 1; ib <= theNBins; ib++) {
+    double t = theMin + (ib - 0.5) * width;
+    n += row[ib];
+    sum += row[ib] * t;
+    sum2 += row[ib] * t * t;
+  }
+  s.entries += n;
+  if (n == 0) return s;
+  s.mean = sum / n;
+  s.rms = sqrt(max(0., sum2 / n - s.mean * s.mean));
+
+  // linear interpolation inside the bin holding half of the in-range entries
+  double below = 0;
+  for (unsigned int ib = 1; ib <= theNBins; ib++) {
+    if (below + row[ib] >= n / 2) {
+      s.median = theMin + (ib - 1 + (n / 2 - below) / row[ib]) * width;
+      break;
+    }
+    below += row[ib];
+  }
+  return s;
+}
+
+TH2F* ChamberTimeMonitor::histogram(const char* name, const char* title) const {
+  const int nChambers = MuonChamberIndex::nChambers;
+  TH2F* h = new TH2F(name, title, nChambers, -0.5, nChambers - 0.5, theNBins, theMin, theMax);
+  h->SetDirectory(0);
+  double entries = 0;
+  for (int ic = 0; ic < nChambers; ic++)
+    for (unsigned int ib = 0; ib < theStride; ib++) {
+      unsigned int n = theCounts[ic * theStride + ib];
+      if (!n) continue;
+      h->SetBinContent(ic + 1, ib, n);
+      entries += n;
+    }
+  h->SetEntries(entries);
+  return h;
+}
+
+void ChamberTimeMonitor::print(ostream& out, unsigned int nWorst, unsigned long minEntries) const {
+  vector<pair<float,int> > worst;
+  unsigned int nFilled = 0;
+  for (int ic = 0; ic < MuonChamberIndex::nChambers; ic++) {
+    Summary s = summary(ic);
+    if (s.entries) nFilled++;
+    unsigned long inRange = s.entries - s.underflow - s.overflow;
+    if (inRange && inRange >= minEntries) worst.push_back(make_pair(fabs(s.mean), ic));
+  }
+  sort(worst.begin(), worst.end(), [](const pair<float,int>& a, const pair<float,int>& b) { return a.first > b.first; });
+  if (worst.size() > nWorst) worst.resize(nWorst);
+
+  out << " Chamber segment times: " << nFilled << " chambers with segments" << endl;
+  if (worst.empty()) return;
+  out << "   largest |mean| (chambers with at least " << minEntries << " segments in range):" << endl;
+  out << "   " << left << setw(18) << "chamber" << right << setw(10) << "segments" << setw(10) << "mean"
+      << setw(10) << "median" << setw(10) << "rms" << endl;
+  for (const auto& w : worst) {
+    Summary s = summary(w.second);
+    out << "   " << left << setw(18) << name(w.second) << right << setw(10) << s.entries << fixed << setprecision(2)
+        << setw(10) << s.mean << setw(10) << s.median << setw(10) << s.rms << endl;
+  }
+  out.unsetf(ios::fixed);
+}
+
+string ChamberTimeMonitor::name(int chamber) {
+  int first, station, third, number;
+  MuonChamberIndex::decode(chamber, first, station, third, number);
+  char buffer[32];
+  if (MuonChamberIndex::isDT(chamber)) snprintf(buffer, sizeof(buffer), "DT W%+d MB%d S%02d", first, station, third);
+    else snprintf(buffer, sizeof(buffer), "CSC ME%c%d/%d C%02d", first == 1 ? '+' : '-', station, third, number);
+  return buffer;
+}
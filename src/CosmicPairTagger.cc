@@ -0,0 +1,88 @@
+#include "UserCode/HSCPTOF/interface/CosmicPairTagger.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+CosmicPairTagger::CosmicPairTagger(double maxAngle)
+  : theMaxAngle(maxAngle),
+    theMinusCos(maxAngle < M_PI ? -cos(maxAngle) : 2.)
+{
+  // small tolerance so that float rounding of the unit vectors cannot lose a pair at a cell edge;
+  // at most 64 cells per axis (larger cells only cost more candidates)
+  double window = (maxAngle < M_PI ? 2. * sin(maxAngle / 2.) : 2.) + 1e-6;
+  theNCells = max(1, min(64, (int)floor(2. / window)));
+}
+
+void CosmicPairTagger::add(unsigned int index, double px, double py, double pz) {
+  double p = sqrt(px * px + py * py + pz * pz);
+  if (p <= 0) return;
+  theDirections.push_back(Direction{float(px / p), float(py / p), float(pz / p), index, 0});
+}
+
+int CosmicPairTagger::coordinate(float v) const {
+  int i = (int)floor((v + 1.f) * 0.5f * theNCells);
+  return max(0, min(theNCells - 1, i));
+}
+
+const vector<CosmicPairTagger::Pair>& CosmicPairTagger::tag() {
+  thePairs.clear();
+  if (theDirections.size() < 2) return thePairs;
+
+  // few directions: all the pairs, the dot product is cheaper than the cell search
+  if (theDirections.size() <= theMaxAllPairs) {
+    for (size_t i = 0; i < theDirections.size(); i++)
+      for (size_t j = i + 1; j < theDirections.size(); j++) check(theDirections[i], theDirections[j]);
+  } else search();
+
+  sort(thePairs.begin(), thePairs.end(), [](const Pair& a, const Pair& b) {
+    return a.first < b.first || (a.first == b.first && a.second < b.second);
+  });
+  return thePairs;
+}
+
+void CosmicPairTagger::search() {
+  for (Direction& d : theDirections) d.cell = cell(coordinate(d.x), coordinate(d.y), coordinate(d.z));
+  sort(theDirections.begin(), theDirections.end(),
+       [](const Direction& a, const Direction& b) { return a.cell < b.cell; });
+  theCells.resize(theDirections.size());
+  for (size_t i = 0; i < theDirections.size(); i++) theCells[i] = theDirections[i].cell;
+
+  for (size_t i = 0; i < theDirections.size(); i++) {
+    const Direction& d1 = theDirections[i];
+    // cells around the opposite direction; the z neighbours of a cell are consecutive
+    int cx = coordinate(-d1.x), cy = coordinate(-d1.y), cz = coordinate(-d1.z);
+    int zlow = max(0, cz - 1), zhigh = min(theNCells - 1, cz + 1);
+    for (int ix = max(0, cx - 1); ix <= min(theNCells - 1, cx + 1); ix++)
+      for (int iy = max(0, cy - 1); iy <= min(theNCells - 1, cy + 1); iy++) {
+        unsigned int last = cell(ix, iy, zhigh);
+        size_t j = lower_bound(theCells.begin(), theCells.end(), cell(ix, iy, zlow)) - theCells.begin();
+        for (; j < theDirections.size() && theCells[j] <= last; j++) {
+          // every pair is considered once, from its member with the lower position in cell order
+          if (j > i) check(d1, theDirections[j]);
+        }
+      }
+  }
+}
+
+void CosmicPairTagger::check(const Direction& d1, const Direction& d2) {
+  double dot = d1.x * d2.x + d1.y * d2.y + d1.z * d2.z;
+  if (dot >= theMinusCos) return;
+  float angle = deviation(d1, d2);
+  if (d1.index < d2.index) thePairs.push_back(Pair{d1.index, d2.index, angle});
+  else thePairs.push_back(Pair{d2.index, d1.index, angle});
+}
+
+// pi minus the opening angle, accurate also for small angles
+float CosmicPairTagger::deviation(const Direction& d1, const Direction& d2) {
+  double sx = d1.x + d2.x, sy = d1.y + d2.y, sz = d1.z + d2.z;
+  return 2. * asin(min(1., 0.5 * sqrt(sx * sx + sy * sy + sz * sz)));
+}
+
+unsigned int CosmicPairTagger::count(const vector<Pair>& pairs, double angleCut) {
+  unsigned int n = 0;
+  for (const Pair& pair : pairs)
+    if (pair.angle < angleCut) n++;
+  return n;
+}
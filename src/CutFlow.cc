@@ -0,0 +1,53 @@
+#include "UserCode/HSCPTOF/interface/CutFlow.h"
+
+#include <TH1F.h>
+
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+CutFlow::CutFlow(const string& name, const vector<string>& labels)
+  : theName(name),
+    theLabels(labels),
+    theCounts(labels.size(), 0)
+{
+}
+
+void CutFlow::merge(const CutFlow& other) {
+  if (other.theLabels != theLabels)
+    throw runtime_error("CutFlow::merge: " + other.theName + " has different stages than " + theName);
+  for (unsigned int i = 0; i < theCounts.size(); i++) theCounts[i] += other.theCounts[i];
+}
+
+TH1F* CutFlow::histogram() const {
+  const int n = theCounts.size();
+  TH1F* h = new TH1F(theName.c_str(), (theName + ";;Passed").c_str(), n, 0., n);
+  h->SetDirectory(0);
+  for (int i = 0; i < n; i++) {
+    h->GetXaxis()->SetBinLabel(i + 1, theLabels[i].c_str());
+    h->SetBinContent(i + 1, theCounts[i]);
+  }
+  h->SetEntries(n ? theCounts[0] : 0);
+  return h;
+}
+
+void CutFlow::print(ostream& out) const {
+  unsigned int width = 8;
+  for (unsigned int i = 0; i < theLabels.size(); i++)
+    if (theLabels[i].size() > width) width = theLabels[i].size();
+
+  out << " Cut flow " << theName << ":" << endl;
+  ios_base::fmtflags flags = out.flags();
+  for (unsigned int i = 0; i < theCounts.size(); i++) {
+    out << "   " << left << setw(width) << theLabels[i] << right << setw(14) << theCounts[i];
+    if (i > 0) {
+      double rel = theCounts[i - 1] ? 100. * theCounts[i] / theCounts[i - 1] : 0.;
+      double abs = theCounts[0] ? 100. * theCounts[i] / theCounts[0] : 0.;
+      out << fixed << setprecision(2) << setw(9) << rel << "%" << setw(9) << abs << "%";
+    }
+    out << endl;
+  }
+  out.flags(flags);
+}
@@ -0,0 +1,71 @@
+#include "UserCode/HSCPTOF/interface/DimuonPairBuilder.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  const double muonMass2 = 0.011163691;
+}
+
+void DimuonPairBuilder::clear() {
+  theIndex.clear();
+  theCharge.clear();
+  thePx.clear();
+  thePy.clear();
+  thePz.clear();
+  theE.clear();
+  theFirst.clear();
+  theSecond.clear();
+  theMass.clear();
+}
+
+void DimuonPairBuilder::add(unsigned int index, double px, double py, double pz, int charge) {
+  theIndex.push_back(index);
+  theCharge.push_back(charge);
+  thePx.push_back(px);
+  thePy.push_back(py);
+  thePz.push_back(pz);
+  theE.push_back(sqrt(px * px + py * py + pz * pz + muonMass2));
+}
+
+void DimuonPairBuilder::build() {
+  const unsigned int n = size();
+  const unsigned int nPairs = n > 1 ? n * (n - 1) / 2 : 0;
+  theFirst.resize(nPairs);
+  theSecond.resize(nPairs);
+  theMass.resize(nPairs);
+
+  const float* __restrict__ px = thePx.data();
+  const float* __restrict__ py = thePy.data();
+  const float* __restrict__ pz = thePz.data();
+  const float* __restrict__ e = theE.data();
+  float* __restrict__ mass = theMass.data();
+
+  unsigned int k = 0;
+  for (unsigned int i = 0; i + 1 < n; i++) {
+    const float pxi = px[i], pyi = py[i], pzi = pz[i], ei = e[i];
+    const unsigned int m = n - i - 1;
+    const float* __restrict__ pxj = px + i + 1;
+    const float* __restrict__ pyj = py + i + 1;
+    const float* __restrict__ pzj = pz + i + 1;
+    const float* __restrict__ ej = e + i + 1;
+    float* __restrict__ out = mass + k;
+    // vectorized: no branches, no calls, contiguous loads and stores
+    for (unsigned int j = 0; j < m; j++) {
+      float sx = pxi + pxj[j];
+      float sy = pyi + pyj[j];
+      float sz = pzi + pzj[j];
+      float se = ei + ej[j];
+      float m2 = se * se - sx * sx - sy * sy - sz * sz;
+      out[j] = m2 > 0.f ? m2 : 0.f;
+    }
+    // separate loop, sqrt may set errno and would block the vectorization above
+    for (unsigned int j = 0; j < m; j++) {
+      out[j] = sqrt(out[j]);
+      theFirst[k + j] = i;
+      theSecond[k + j] = i + 1 + j;
+    }
+    k += m;
+  }
+}
@@ -0,0 +1,122 @@
+#include "UserCode/HSCPTOF/interface/EventIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+  const char theMagic[8] = {'H','S','C','P','I','N','D','X'};
+  const uint32_t theVersion = 2;
+
+  template <class T> void put(ofstream& out, const T& value) {
+    out.write((const char*)&value, sizeof(T));
+  }
+}
+
+EventIndexWriter::EventIndexWriter(const string& fileName)
+  : theFileName(fileName),
+    theClosed(false)
+{
+}
+
+EventIndexWriter::~EventIndexWriter() {
+  try {
+    close();
+  } catch (const exception&) {}
+}
+
+uint32_t EventIndexWriter::file(const string& name) {
+  map<string, uint32_t>::const_iterator it = theFileIndex.find(name);
+  if (it != theFileIndex.end()) return it->second;
+  uint32_t index = theFiles.size();
+  theFiles.push_back(name);
+  theFileIndex[name] = index;
+  return index;
+}
+
+void EventIndexWriter::close() {
+  if (theClosed) return;
+  theClosed = true;
+
+  ofstream out(theFileName.c_str(), ios::binary | ios::trunc);
+  if (!out) throw runtime_error("EventIndexWriter: cannot open " + theFileName);
+
+  sort(theRecords.begin(), theRecords.end());
+  out.write(theMagic, sizeof(theMagic));
+  put(out, theVersion);
+  put(out, (uint32_t)sizeof(EventIndexRecord));
+  put(out, (uint64_t)theRecords.size());
+  put(out, (uint32_t)theFiles.size());
+  for (const string& name : theFiles) {
+    put(out, (uint32_t)name.size());
+    out.write(name.data(), name.size());
+  }
+  if (!theRecords.empty()) out.write((const char*)theRecords.data(), theRecords.size() * sizeof(EventIndexRecord));
+  if (!out) throw runtime_error("EventIndexWriter: write error on " + theFileName);
+}
+
+EventIndexReader::EventIndexReader(const string& fileName)
+  : theFile(fileName.c_str(), ios::binary),
+    theFileName(fileName),
+    theSize(0)
+{
+  if (!theFile) throw runtime_error("EventIndexReader: cannot open " + fileName);
+
+  char magic[sizeof(theMagic)];
+  uint32_t version = 0, recordSize = 0, nFiles = 0;
+  theFile.read(magic, sizeof(magic));
+  theFile.read((char*)&version, sizeof(version));
+  if (!theFile || memcmp(magic, theMagic, sizeof(magic)) || version != theVersion)
+    throw runtime_error("EventIndexReader: " + fileName + " is not a version " + to_string(theVersion) + " event index");
+  theFile.read((char*)&recordSize, sizeof(recordSize));
+  if (recordSize != sizeof(EventIndexRecord))
+    throw runtime_error("EventIndexReader: " + fileName + " was written with a different record layout");
+
+  theFile.read((char*)&theSize, sizeof(theSize));
+  theFile.read((char*)&nFiles, sizeof(nFiles));
+  for (uint32_t i = 0; theFile && i < nFiles; i++) {
+    uint32_t length = 0;
+    theFile.read((char*)&length, sizeof(length));
+    string name(length, ' ');
+    if (length) theFile.read(&name[0], length);
+    theFiles.push_back(name);
+  }
+  if (!theFile) throw runtime_error("EventIndexReader: truncated header in " + fileName);
+  theOffset = theFile.tellg();
+}
+
+EventIndexRecord EventIndexReader::record(uint64_t i) {
+  if (i >= theSize) throw out_of_range("EventIndexReader: record out of range");
+  EventIndexRecord record;
+  theFile.clear();
+  theFile.seekg(theOffset + (streamoff)(i * sizeof(EventIndexRecord)));
+  theFile.read((char*)&record, sizeof(record));
+  if (!theFile) throw runtime_error("EventIndexReader: truncated record in " + theFileName);
+  return record;
+}
+
+vector<EventIndexRecord> EventIndexReader::find(uint32_t run, uint32_t lumi, uint64_t event) {
+  EventIndexRecord key;
+  key.run = run;
+  key.lumi = lumi;
+  key.event = event;
+  key.muon = 0;
+
+  // first record not before (run, lumi, event, muon 0)
+  uint64_t low = 0, high = theSize;
+  while (low < high) {
+    uint64_t mid = low + (high - low) / 2;
+    if (record(mid) < key) low = mid + 1;
+      else high = mid;
+  }
+
+  vector<EventIndexRecord> records;
+  for (uint64_t i = low; i < theSize; i++) {
+    EventIndexRecord r = record(i);
+    if (r.run != run || r.lumi != lumi || r.event != event) break;
+    records.push_back(r);
+  }
+  return records;
+}
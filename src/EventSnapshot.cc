@@ -0,0 +1,190 @@
+#include "UserCode/HSCPTOF/interface/EventSnapshot.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace std;
+
+namespace {
+  const char theMagic[8] = {'H','S','C','P','S','N','A','P'};
+  const unsigned int theVersion = 2;
+
+  // the record layouts; a file written with other sizes is refused
+  const unsigned int theSizes[] = {
+    sizeof(EventSnapshot::Muon), sizeof(MuonHitCounter::ChamberMatch), sizeof(MuonHitCounter::TrackHit),
+    sizeof(EventSnapshot::Segment), sizeof(EventSnapshot::RPCHit), sizeof(EventSnapshot::Candidate),
+    sizeof(EventSnapshot::Vertex)
+  };
+  const unsigned int theNSizes = sizeof(theSizes) / sizeof(theSizes[0]);
+
+  template <class T> void put(string& buffer, const T& value) {
+    static_assert(is_trivially_copyable<T>::value, "snapshot fields are copied as bytes");
+    buffer.append((const char*)&value, sizeof(T));
+  }
+
+  template <class T> void put(string& buffer, const vector<T>& values) {
+    static_assert(is_trivially_copyable<T>::value, "snapshot fields are copied as bytes");
+    put(buffer, (unsigned int)values.size());
+    if (!values.empty()) buffer.append((const char*)values.data(), values.size() * sizeof(T));
+  }
+
+  // reads from a record, checking its length
+  class Record {
+  public:
+    Record(const string& buffer) : theBuffer(buffer), thePos(0) {}
+
+    template <class T> void get(T& value) {
+      check(sizeof(T));
+      memcpy(&value, theBuffer.data() + thePos, sizeof(T));
+      thePos += sizeof(T);
+    }
+
+    template <class T> void get(vector<T>& values) {
+      unsigned int n;
+      get(n);
+      check((unsigned long long)n * sizeof(T));
+      values.resize(n);
+      if (n) memcpy(values.data(), theBuffer.data() + thePos, n * sizeof(T));
+      thePos += n * sizeof(T);
+    }
+
+  private:
+    void check(unsigned long long n) const {
+      if (thePos + n > theBuffer.size()) throw runtime_error("EventSnapshotReader: truncated event record");
+    }
+
+    const string& theBuffer;
+    unsigned long long thePos;
+  };
+}
+
+void EventSnapshot::clear() {
+  run = lumi = 0;
+  event = 0;
+  muons.clear();
+  variables.clear();
+  matches.clear();
+  rpcTrackHits.clear();
+  segments.clear();
+  rpcHits.clear();
+  l1.clear();
+  genMuons.clear();
+  tpMuons.clear();
+  vertices.clear();
+}
+
+EventSnapshotWriter::EventSnapshotWriter(const string& fileName, const vector<string>& variableNames)
+  : theFile(fileName.c_str(), ios::binary | ios::trunc),
+    theNVariables(variableNames.size()),
+    theWritten(0),
+    theBytes(0)
+{
+  if (!theFile) throw runtime_error("EventSnapshotWriter: cannot open " + fileName);
+
+  string header(theMagic, sizeof(theMagic));
+  put(header, theVersion);
+  put(header, theNSizes);
+  for (unsigned int i = 0; i < theNSizes; i++) put(header, theSizes[i]);
+  put(header, theNVariables);
+  for (const string& name : variableNames) {
+    put(header, (unsigned int)name.size());
+    header += name;
+  }
+  theFile.write(header.data(), header.size());
+  theBytes += header.size();
+}
+
+void EventSnapshotWriter::write(const EventSnapshot& event) {
+  if (event.variables.size() != event.muons.size() * theNVariables)
+    throw runtime_error("EventSnapshotWriter: wrong number of muon variables");
+
+  theBuffer.clear();
+  put(theBuffer, event.run);
+  put(theBuffer, event.lumi);
+  put(theBuffer, event.event);
+  put(theBuffer, event.muons);
+  put(theBuffer, event.variables);
+  put(theBuffer, event.matches);
+  put(theBuffer, event.rpcTrackHits);
+  put(theBuffer, event.segments);
+  put(theBuffer, event.rpcHits);
+  put(theBuffer, event.l1);
+  put(theBuffer, event.genMuons);
+  put(theBuffer, event.tpMuons);
+  put(theBuffer, event.vertices);
+
+  unsigned long long size = theBuffer.size();
+  theFile.write((const char*)&size, sizeof(size));
+  theFile.write(theBuffer.data(), theBuffer.size());
+  if (!theFile) throw runtime_error("EventSnapshotWriter: write error");
+  theWritten++;
+  theBytes += sizeof(size) + theBuffer.size();
+}
+
+EventSnapshotReader::EventSnapshotReader(const string& fileName)
+  : theFile(fileName.c_str(), ios::binary),
+    theFileName(fileName)
+{
+  if (!theFile) throw runtime_error("EventSnapshotReader: cannot open " + fileName);
+
+  char magic[sizeof(theMagic)];
+  unsigned int version = 0, nSizes = 0;
+  theFile.read(magic, sizeof(magic));
+  theFile.read((char*)&version, sizeof(version));
+  if (!theFile || memcmp(magic, theMagic, sizeof(magic)) || version != theVersion)
+    throw runtime_error("EventSnapshotReader: " + fileName + " is not a version " + to_string(theVersion) + " snapshot file");
+
+  theFile.read((char*)&nSizes, sizeof(nSizes));
+  bool sameLayout = theFile && nSizes == theNSizes;
+  for (unsigned int i = 0; sameLayout && i < nSizes; i++) {
+    unsigned int size = 0;
+    theFile.read((char*)&size, sizeof(size));
+    sameLayout = theFile && size == theSizes[i];
+  }
+  if (!sameLayout)
+    throw runtime_error("EventSnapshotReader: " + fileName + " was written with a different record layout");
+
+  unsigned int nVariables = 0;
+  theFile.read((char*)&nVariables, sizeof(nVariables));
+  for (unsigned int i = 0; theFile && i < nVariables; i++) {
+    unsigned int length = 0;
+    theFile.read((char*)&length, sizeof(length));
+    string name(length, ' ');
+    theFile.read(&name[0], length);
+    theVariableNames.push_back(name);
+  }
+  if (!theFile) throw runtime_error("EventSnapshotReader: truncated header in " + fileName);
+}
+
+bool EventSnapshotReader::read(EventSnapshot& event) {
+  unsigned long long size = 0;
+  if (!theFile.read((char*)&size, sizeof(size))) return false;
+  theBuffer.resize(size);
+  if (!theFile.read(&theBuffer[0], size))
+    throw runtime_error("EventSnapshotReader: truncated event record in " + theFileName);
+
+  Record record(theBuffer);
+  record.get(event.run);
+  record.get(event.lumi);
+  record.get(event.event);
+  record.get(event.muons);
+  record.get(event.variables);
+  record.get(event.matches);
+  record.get(event.rpcTrackHits);
+  record.get(event.segments);
+  record.get(event.rpcHits);
+  record.get(event.l1);
+  record.get(event.genMuons);
+  record.get(event.tpMuons);
+  record.get(event.vertices);
+  if (event.variables.size() != event.muons.size() * theVariableNames.size())
+    throw runtime_error("EventSnapshotReader: wrong number of muon variables in " + theFileName);
+  // the replay indexes the arrays with these ranges
+  for (const EventSnapshot::Muon& mu : event.muons)
+    if (mu.firstMatch > event.matches.size() || mu.nMatches > event.matches.size() - mu.firstMatch ||
+        mu.firstRPCHit > event.rpcTrackHits.size() || mu.nRPCHits > event.rpcTrackHits.size() - mu.firstRPCHit)
+      throw runtime_error("EventSnapshotReader: muon hit ranges out of bounds in event " + to_string(event.run) + ":" +
+                          to_string(event.lumi) + ":" + to_string(event.event) + " of " + theFileName);
+  return true;
+}
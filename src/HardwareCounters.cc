@@ -0,0 +1,93 @@
+#include "UserCode/HSCPTOF/interface/HardwareCounters.h"
+
+#include <cstring>
+#include <ctime>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+#ifdef __linux__
+  int openCounter(unsigned long long config, int group) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+  }
+#endif
+}
+
+HardwareCounters::HardwareCounters() : theLeader(-1), theNOpen(0) {
+  for (int i = 0; i < nCounters; i++) theFds[i] = theIndex[i] = -1;
+}
+
+HardwareCounters::~HardwareCounters() {
+  close();
+}
+
+void HardwareCounters::open() {
+  close();
+  theThread = this_thread::get_id();
+#ifdef __linux__
+  static const unsigned long long configs[nCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+  theLeader = openCounter(configs[cycles], -1);
+  if (theLeader < 0) return;
+  theFds[cycles] = theLeader;
+  theIndex[cycles] = theNOpen++;
+  for (int i = cycles + 1; i < nCounters; i++) {
+    theFds[i] = openCounter(configs[i], theLeader);
+    if (theFds[i] >= 0) theIndex[i] = theNOpen++;
+  }
+  ioctl(theLeader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(theLeader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void HardwareCounters::close() {
+#ifdef __linux__
+  for (int i = 0; i < nCounters; i++)
+    if (theFds[i] >= 0) ::close(theFds[i]);
+#endif
+  theLeader = -1;
+  theNOpen = 0;
+  for (int i = 0; i < nCounters; i++) theFds[i] = theIndex[i] = -1;
+}
+
+void HardwareCounters::read(unsigned long long values[nCounters]) const {
+  for (int i = 0; i < nCounters; i++) values[i] = 0;
+#ifdef __linux__
+  if (theLeader >= 0) {
+    // nr, time enabled, time running, one value per counter
+    unsigned long long buffer[3 + nCounters];
+    if (::read(theLeader, buffer, sizeof(buffer)) < (ssize_t)(3 + theNOpen) * (ssize_t)sizeof(buffer[0])) return;
+    double scale = (buffer[2] > 0 && buffer[2] < buffer[1]) ? double(buffer[1]) / buffer[2] : 1.;
+    for (int i = 0; i < nCounters; i++)
+      if (theIndex[i] >= 0) values[i] = buffer[3 + theIndex[i]] * scale;
+    return;
+  }
+#endif
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) values[cycles] = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  values[cycles] = clock() * (1000000000ULL / CLOCKS_PER_SEC);
+#endif
+}
+
+const char* HardwareCounters::name(int counter) {
+  static const char* names[nCounters] = {"cycles", "instructions", "LLC misses", "branch misses"};
+  return names[counter];
+}
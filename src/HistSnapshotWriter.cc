@@ -0,0 +1,137 @@
+#include "UserCode/HSCPTOF/interface/HistSnapshotWriter.h"
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TParameter.h>
+
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+HistSnapshotWriter::HistSnapshotWriter(const string& fileName, unsigned int everyNEvents, double everySeconds)
+  : theFileName(fileName),
+    theEveryNEvents(everyNEvents),
+    theEverySeconds(everySeconds),
+    theEvents(0),
+    theLastEvents(0),
+    theLastTime(chrono::steady_clock::now()),
+    thePendingEvents(0),
+    theHasPending(false),
+    theStop(false),
+    theWritten(0),
+    theDropped(0)
+{
+  if (!enabled()) return;
+  ROOT::EnableThreadSafety();
+  theThread = thread(&HistSnapshotWriter::run, this);
+}
+
+HistSnapshotWriter::~HistSnapshotWriter() {
+  stop();
+}
+
+bool HistSnapshotWriter::newEvent() {
+  if (!enabled()) return false;
+  theEvents++;
+
+  bool due = theEveryNEvents > 0 && theEvents - theLastEvents >= theEveryNEvents;
+  if (!due && theEverySeconds > 0) {
+    // reading the clock is cheap, but there is no need to do it for every event
+    if (theEvents % 16 == 0) {
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - theLastTime;
+      due = elapsed.count() >= theEverySeconds;
+    }
+  }
+  if (due) {
+    theLastEvents = theEvents;
+    theLastTime = chrono::steady_clock::now();
+  }
+  return due;
+}
+
+void HistSnapshotWriter::submit(vector<TObject*>& objects) {
+  if (!theThread.joinable()) {
+    for (TObject* obj : objects) delete obj;
+    objects.clear();
+    return;
+  }
+
+  vector<TObject*> replaced;
+  {
+    lock_guard<mutex> lock(theMutex);
+    if (theHasPending) {
+      replaced.swap(thePending);
+      theDropped++;
+    }
+    thePending.swap(objects);
+    thePendingEvents = theEvents;
+    theHasPending = true;
+  }
+  theCondition.notify_one();
+
+  for (TObject* obj : replaced) delete obj;
+  objects.clear();
+}
+
+void HistSnapshotWriter::cloneHistograms(TDirectory* dir, vector<TObject*>& objects) {
+  TIter next(dir->GetList());
+  while (TObject* obj = next()) {
+    TH1* h = dynamic_cast<TH1*>(obj);
+    if (!h) continue;
+    TH1* copy = (TH1*)h->Clone();
+    copy->SetDirectory(0);
+    objects.push_back(copy);
+  }
+}
+
+void HistSnapshotWriter::stop() {
+  if (!theThread.joinable()) return;
+  {
+    lock_guard<mutex> lock(theMutex);
+    theStop = true;
+  }
+  theCondition.notify_one();
+  theThread.join();
+}
+
+void HistSnapshotWriter::run() {
+  while (true) {
+    vector<TObject*> objects;
+    unsigned long nEvents;
+    {
+      unique_lock<mutex> lock(theMutex);
+      theCondition.wait(lock, [this] { return theHasPending || theStop; });
+      if (!theHasPending) return;
+      objects.swap(thePending);
+      nEvents = thePendingEvents;
+      theHasPending = false;
+    }
+    write(objects, nEvents);
+    for (TObject* obj : objects) delete obj;
+  }
+}
+
+void HistSnapshotWriter::write(vector<TObject*>& objects, unsigned long nEvents) {
+  string tmpName = theFileName + ".tmp";
+  unique_ptr<TFile> file(TFile::Open(tmpName.c_str(), "RECREATE"));
+  if (!file || file->IsZombie()) {
+    cout << " HistSnapshotWriter: cannot create " << tmpName << endl;
+    return;
+  }
+
+  file->cd();
+  for (TObject* obj : objects) obj->Write();
+  TParameter<Long64_t> events("snapshotEvents", nEvents);
+  events.Write();
+  file->Close();
+
+  if (rename(tmpName.c_str(), theFileName.c_str()) != 0) {
+    cout << " HistSnapshotWriter: cannot rename " << tmpName << " to " << theFileName << endl;
+    return;
+  }
+  theWritten++;
+}
@@ -0,0 +1,119 @@
+#include "UserCode/HSCPTOF/interface/MemoryReport.h"
+
+#include <TArrayC.h>
+#include <TArrayD.h>
+#include <TArrayF.h>
+#include <TArrayI.h>
+#include <TArrayS.h>
+#include <TBranch.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TObjArray.h>
+#include <TTree.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+void MemoryReport::add(const string& group, size_t bytes, size_t maxBytes) {
+  Group& g = theGroups[group];
+  g.n++;
+  g.bytes += bytes;
+  g.maxBytes += maxBytes;
+}
+
+void MemoryReport::addHistograms(TDirectory* dir) {
+  TIter next(dir->GetList());
+  while (TObject* obj = next()) {
+    if (TH1* h = dynamic_cast<TH1*>(obj)) addHistogram(h);
+      else if (TDirectory* sub = dynamic_cast<TDirectory*>(obj)) addHistograms(sub);
+  }
+}
+
+void MemoryReport::addHistogram(const TH1* h) {
+  string name = h->GetName();
+  if (name.compare(0, 3, "hi_") == 0) name = name.substr(3);
+  add(name.substr(0, name.find('_')), histogramBytes(h));
+}
+
+namespace {
+  size_t basketBytes(TObjArray* branches, unsigned int& n) {
+    size_t bytes = 0;
+    for (int i = 0; i < branches->GetEntriesFast(); i++) {
+      TBranch* b = static_cast<TBranch*>(branches->UncheckedAt(i));
+      n++;
+      bytes += b->GetBasketSize();
+      bytes += basketBytes(b->GetListOfBranches(), n);
+    }
+    return bytes;
+  }
+}
+
+void MemoryReport::addTree(const TTree* tree) {
+  // one basket per branch is held while filling
+  unsigned int n = 0;
+  size_t bytes = basketBytes(const_cast<TTree*>(tree)->GetListOfBranches(), n);
+  Group& g = theGroups[string("tree ") + tree->GetName()];
+  g.n += n;
+  g.bytes += bytes;
+  g.maxBytes += bytes;
+}
+
+size_t MemoryReport::bytes() const {
+  size_t sum = 0;
+  for (const auto& g : theGroups) sum += g.second.bytes;
+  return sum;
+}
+
+size_t MemoryReport::maxBytes() const {
+  size_t sum = 0;
+  for (const auto& g : theGroups) sum += g.second.maxBytes;
+  return sum;
+}
+
+size_t MemoryReport::histogramBytes(const TH1* h) {
+  size_t bytes = sizeof(*h);
+  if (const TArrayF* a = dynamic_cast<const TArrayF*>(h)) bytes += a->GetSize() * sizeof(Float_t);
+    else if (const TArrayD* a = dynamic_cast<const TArrayD*>(h)) bytes += a->GetSize() * sizeof(Double_t);
+    else if (const TArrayI* a = dynamic_cast<const TArrayI*>(h)) bytes += a->GetSize() * sizeof(Int_t);
+    else if (const TArrayS* a = dynamic_cast<const TArrayS*>(h)) bytes += a->GetSize() * sizeof(Short_t);
+    else if (const TArrayC* a = dynamic_cast<const TArrayC*>(h)) bytes += a->GetSize() * sizeof(Char_t);
+  bytes += h->GetSumw2N() * sizeof(Double_t);
+  bytes += (h->GetXaxis()->GetXbins()->GetSize() + h->GetYaxis()->GetXbins()->GetSize()
+            + h->GetZaxis()->GetXbins()->GetSize()) * sizeof(Double_t);
+  return bytes;
+}
+
+void MemoryReport::processMemory(long& rssKB, long& peakKB) {
+  rssKB = peakKB = 0;
+  ifstream status("/proc/self/status");
+  string line;
+  while (getline(status, line)) {
+    istringstream is(line);
+    string key;
+    is >> key;
+    if (key == "VmRSS:") is >> rssKB;
+      else if (key == "VmHWM:") is >> peakKB;
+  }
+}
+
+void MemoryReport::print(ostream& out, const string& when) const {
+  long rss, peak;
+  processMemory(rss, peak);
+
+  ios_base::fmtflags flags = out.flags();
+  out << " Memory " << theName << " at " << when << " (kB; max: when every bin/block is filled):" << endl;
+  out << "   " << left << setw(20) << "group" << right << setw(8) << "objects" << setw(12) << "now"
+      << setw(12) << "max" << endl;
+  out << fixed << setprecision(1);
+  for (const auto& g : theGroups)
+    out << "   " << left << setw(20) << g.first << right << setw(8) << g.second.n << setw(12)
+        << g.second.bytes/1024. << setw(12) << g.second.maxBytes/1024. << endl;
+  out << "   " << left << setw(20) << "total" << right << setw(8) << "" << setw(12) << bytes()/1024.
+      << setw(12) << maxBytes()/1024. << endl;
+  out << "   process RSS " << rss << " kB, high-water mark " << peak << " kB" << endl;
+  out.flags(flags);
+}
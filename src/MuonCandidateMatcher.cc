@@ -0,0 +1,53 @@
+#include "UserCode/HSCPTOF/interface/MuonCandidateMatcher.h"
+
+#include <cmath>
+
+using namespace std;
+
+void MuonCandidateMatcher::clear() {
+  theIndex.clear();
+  theEta.clear();
+  thePhi.clear();
+}
+
+void MuonCandidateMatcher::add(unsigned int index, float eta, float phi) {
+  theIndex.push_back(index);
+  theEta.push_back(eta);
+  thePhi.push_back(phi);
+}
+
+float MuonCandidateMatcher::deltaPhi(float phi1, float phi2) {
+  float dphi = phi1 - phi2;
+  if (dphi > float(M_PI) || dphi < -float(M_PI)) dphi = remainder(dphi, float(2. * M_PI));
+  return dphi;
+}
+
+int MuonCandidateMatcher::matchTruth(bool hasTrk, float trkEta, float trkPhi,
+                                     bool hasSta, float staEta, float staPhi) const {
+  for (unsigned int i = 0; i < theIndex.size(); i++) {
+    if (hasTrk && fabs(theEta[i] - trkEta) < 0.05 && fabs(deltaPhi(thePhi[i], trkPhi)) < 0.05) return theIndex[i];
+    if (hasSta && fabs(theEta[i] - staEta) < 0.05 && fabs(deltaPhi(thePhi[i], staPhi)) < 0.05) return theIndex[i];
+  }
+  return -1;
+}
+
+void MuonCandidateMatcher::matchL1(unsigned int self, float eta, float phi, const vector<Direction>& muons,
+                                   vector<unsigned int>& matches) const {
+  matches.clear();
+  for (unsigned int i = 0; i < theIndex.size(); i++) {
+    float deta = fabs(theEta[i] - eta);
+    float dphi = fabs(deltaPhi(thePhi[i], phi));
+    if (dphi >= 0.1 || deta >= 0.4) continue;
+
+    // candidates closer to another muon belong to that one
+    bool closer = false;
+    for (const Direction& mu : muons) {
+      if (mu.index == self) continue;
+      if (fabs(theEta[i] - mu.eta) < deta && fabs(deltaPhi(thePhi[i], mu.phi)) < dphi) {
+        closer = true;
+        break;
+      }
+    }
+    if (!closer) matches.push_back(theIndex[i]);
+  }
+}
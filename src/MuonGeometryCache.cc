@@ -0,0 +1,65 @@
+#include "UserCode/HSCPTOF/interface/MuonGeometryCache.h"
+
+#include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "Geometry/DTGeometry/interface/DTGeometry.h"
+#include "Geometry/CSCGeometry/interface/CSCGeometry.h"
+
+MuonGeometryCache::MuonGeometryCache()
+  : theChambers(MuonChamberIndex::nChambers),
+    theLayers(MuonChamberIndex::nLayers),
+    theNBuilds(0)
+{
+  for (auto& t : theChambers) t.valid = false;
+  for (auto& t : theLayers) t.valid = false;
+}
+
+bool MuonGeometryCache::update(const edm::EventSetup& iSetup) {
+  if (!theWatcher.check(iSetup)) return false;
+
+  edm::ESHandle<DTGeometry> dtGeometry;
+  iSetup.get<MuonGeometryRecord>().get(dtGeometry);
+  edm::ESHandle<CSCGeometry> cscGeometry;
+  iSetup.get<MuonGeometryRecord>().get(cscGeometry);
+
+  for (auto& t : theChambers) t.valid = false;
+  for (auto& t : theLayers) t.valid = false;
+
+  for (const DTChamber* det : dtGeometry->chambers())
+    fill(theChambers[MuonChamberIndex::chamber(det->id())], *det);
+  for (const DTLayer* det : dtGeometry->layers())
+    fill(theLayers[MuonChamberIndex::layer(det->id())], *det);
+  for (const CSCChamber* det : cscGeometry->chambers())
+    fill(theChambers[MuonChamberIndex::chamber(det->id())], *det);
+  for (const CSCLayer* det : cscGeometry->layers())
+    fill(theLayers[MuonChamberIndex::layer(det->id())], *det);
+
+  theNBuilds++;
+  return true;
+}
+
+const MuonDetTransform* MuonGeometryCache::chamber(DetId id) const {
+  int index = MuonChamberIndex::chamber(id);
+  if (index < 0 || !theChambers[index].valid) return 0;
+  return &theChambers[index];
+}
+
+const MuonDetTransform* MuonGeometryCache::layer(DetId id) const {
+  int index = MuonChamberIndex::layer(id);
+  if (index < 0 || !theLayers[index].valid) return 0;
+  return &theLayers[index];
+}
+
+void MuonGeometryCache::fill(MuonDetTransform& t, const GeomDet& det) {
+  const Surface& surface = det.surface();
+  const Surface::PositionType& pos = surface.position();
+  const Surface::RotationType& rot = surface.rotation();
+
+  t.pos[0] = pos.x(); t.pos[1] = pos.y(); t.pos[2] = pos.z();
+  // rows of the rotation are the local axes in the global frame (toGlobal = pos + R^T * local)
+  t.ex[0] = rot.xx(); t.ex[1] = rot.xy(); t.ex[2] = rot.xz();
+  t.ey[0] = rot.yx(); t.ey[1] = rot.yy(); t.ey[2] = rot.yz();
+  t.ez[0] = rot.zx(); t.ez[1] = rot.zy(); t.ez[2] = rot.zz();
+  t.dist = pos.mag();
+  t.valid = true;
+}
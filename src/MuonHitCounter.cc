@@ -0,0 +1,144 @@
+#include "UserCode/HSCPTOF/interface/MuonHitCounter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+  const float theDTCut = 25.;
+  const float theCSCCut = 25.;
+  const float theRPCCut = 30.;
+  const float theRecHitCone = 20.;
+}
+
+void MuonHitCounter::clear() {
+  for (int k = 0; k < NKinds; k++) theItems[k].clear();
+}
+
+void MuonHitCounter::add(int kind, unsigned int id, float x, float y, int n) {
+  Item item = {id, x, y, n};
+  theItems[kind].push_back(item);
+}
+
+void MuonHitCounter::addDTSegment(unsigned int chamber, float x, float y) { add(DTSegments, chamber, x, y, 0); }
+void MuonHitCounter::addCSCSegment(unsigned int chamber, float x, float y, int nHits) { add(CSCSegments, chamber, x, y, nHits); }
+void MuonHitCounter::addRPCHit(unsigned int roll, float x, int bx) { add(RPCHits, roll, x, 0, bx); }
+void MuonHitCounter::addDTRecHit(unsigned int layer, float x) { add(DTRecHits, layer, x, 0, 0); }
+void MuonHitCounter::addCSCRecHit(unsigned int layer, float x, float y) { add(CSCRecHits, layer, x, y, 0); }
+
+void MuonHitCounter::build() {
+  // stable: the objects of one detector keep the order of the collection
+  for (int k = 0; k < NKinds; k++)
+    stable_sort(theItems[k].begin(), theItems[k].end(),
+                [](const Item& a, const Item& b) { return a.id < b.id; });
+}
+
+void MuonHitCounter::range(int kind, unsigned int id, Iterator& begin, Iterator& end) const {
+  const vector<Item>& items = theItems[kind];
+  begin = lower_bound(items.begin(), items.end(), id, [](const Item& a, unsigned int i) { return a.id < i; });
+  end = begin;
+  while (end != items.end() && end->id == id) ++end;
+}
+
+void MuonHitCounter::countDTSegments(const vector<ChamberMatch>& matches, int stations[4]) const {
+  vector<float> xs, ys;
+  for (const ChamberMatch& ch : matches) {
+    if (ch.detector != DT || ch.station < 1 || ch.station > 4) continue;
+    Iterator begin, end;
+    range(DTSegments, ch.chamber, begin, end);
+
+    xs.clear();
+    ys.clear();
+    for (Iterator seg = begin; seg != end; ++seg) {
+      if (seg->x != 0 && ch.x != 0 && fabs(seg->x - ch.x) < theDTCut) {
+        bool found = false;
+        for (float x : xs)
+          if (fabs(x - seg->x) < 0.1) { found = true; break; }
+        if (!found) xs.push_back(seg->x);
+      }
+      if (seg->y != 0 && ch.y != 0 && fabs(seg->y - ch.y) < theDTCut) {
+        bool found = false;
+        for (float y : ys)
+          if (fabs(y - seg->y) < 0.1) { found = true; break; }
+        if (!found) ys.push_back(seg->y);
+      }
+    }
+
+    int nsegs = max(xs.size(), ys.size());
+    if (ch.hasBestSegment) nsegs--;
+    if (nsegs > 0) stations[ch.station - 1] += nsegs;
+  }
+}
+
+void MuonHitCounter::countCSCSegments(const vector<ChamberMatch>& matches, int stations[4]) const {
+  vector<float> phis;
+  vector<int> nhits;
+  for (const ChamberMatch& ch : matches) {
+    if (ch.detector != CSC || ch.station < 1 || ch.station > 4) continue;
+    Iterator begin, end;
+    range(CSCSegments, ch.chamber, begin, end);
+
+    phis.clear();
+    nhits.clear();
+    int nsegs = 0;
+    for (Iterator seg = begin; seg != end; ++seg) {
+      if (seg->x == 0 || seg->y == 0) continue;
+      float dx = seg->x - ch.x, dy = seg->y - ch.y;
+      if (sqrt(dx * dx + dy * dy) >= theCSCCut) continue;
+      float phi = atan2(seg->y, seg->x);
+      // phi and number of hits are compared independently over the kept segments
+      bool samePhi = false, sameHits = false;
+      for (float p : phis)
+        if (fabs(p - phi) < 0.0002) { samePhi = true; break; }
+      if (samePhi)
+        for (int n : nhits)
+          if (abs(n - seg->n) < 2) { sameHits = true; break; }
+      if (samePhi && sameHits) continue;
+      phis.push_back(phi);
+      nhits.push_back(seg->n);
+      nsegs++;
+    }
+
+    if (ch.hasBestSegment) nsegs--;
+    if (nsegs > 0) stations[ch.station - 1] += nsegs;
+  }
+}
+
+void MuonHitCounter::countRPCHits(const vector<TrackHit>& hits, int stations[4]) const {
+  // (station-1)*2 + layer-1
+  int layers[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  for (const TrackHit& hit : hits) {
+    if (hit.detector != RPC || hit.station < 1 || hit.station > 4 || hit.layer < 1 || hit.layer > 2) continue;
+    Iterator begin, end;
+    range(RPCHits, hit.detId, begin, end);
+    for (Iterator rpc = begin; rpc != end; ++rpc)
+      if (rpc->n == 0 && fabs(hit.x - rpc->x) < theRPCCut) layers[(hit.station - 1) * 2 + hit.layer - 1]++;
+  }
+  stations[0] = max(layers[0], layers[1]);
+  stations[1] = max(layers[2], layers[3]);
+  stations[2] = layers[4];
+  stations[3] = layers[6];
+}
+
+void MuonHitCounter::countRecHits(const vector<TrackHit>& hits, int stations[4]) const {
+  for (int i = 0; i < 4; i++) stations[i] = 0;
+  for (const TrackHit& hit : hits) {
+    if (hit.station < 1 || hit.station > 4) continue;
+    Iterator begin, end;
+    int nRecHits = 0;
+    if (hit.detector == DT) {
+      range(DTRecHits, hit.detId, begin, end);
+      for (Iterator rh = begin; rh != end; ++rh)
+        if (fabs(rh->x - hit.x) < theRecHitCone) nRecHits++;
+    } else if (hit.detector == CSC) {
+      range(CSCRecHits, hit.detId, begin, end);
+      for (Iterator rh = begin; rh != end; ++rh) {
+        float dx = rh->x - hit.x, dy = rh->y - hit.y;
+        if (sqrt(dx * dx + dy * dy) < theRecHitCone) nRecHits++;
+      }
+    } else continue;
+    if (nRecHits > stations[hit.station - 1]) stations[hit.station - 1] = nRecHits;
+  }
+}
@@ -0,0 +1,79 @@
+#include "UserCode/HSCPTOF/interface/MuonTimeCalibration.h"
+#include "UserCode/HSCPTOF/interface/MuonChamberIndex.h"
+
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+MuonTimeCalibration::MuonTimeCalibration(const string& fileName)
+  : theFirstRun(0),
+    theLastRun(UINT_MAX),
+    theOffsets(MuonChamberIndex::nChambers, 0.f),
+    theNCurrent(0)
+{
+  if (fileName.empty()) return;
+  ifstream in(fileName.c_str());
+  if (!in) throw runtime_error("MuonTimeCalibration: cannot open " + fileName);
+
+  string line;
+  for (unsigned int nLine = 1; getline(in, line); nLine++) {
+    size_t comment = line.find('#');
+    if (comment != string::npos) line.erase(comment);
+    istringstream words(line);
+    string kind;
+    if (!(words >> kind)) continue;
+
+    bool ok = false;
+    if (kind == "iov") {
+      IOV iov;
+      ok = bool(words >> iov.firstRun);
+      if (ok) theIOVs.push_back(iov);
+    } else if (kind == "DT" || kind == "CSC") {
+      int a, b, c, d = 0;
+      Entry entry;
+      if (kind == "DT") {
+        ok = bool(words >> a >> b >> c >> entry.offset)
+             && a >= -2 && a <= 2 && b >= 1 && b <= 4 && c >= 1 && c <= 14;
+        if (ok) entry.chamber = MuonChamberIndex::dt(a, b, c);
+      } else {
+        ok = bool(words >> a >> b >> c >> d >> entry.offset)
+             && a >= 1 && a <= 2 && b >= 1 && b <= 4 && c >= 1 && c <= 4 && d >= 1 && d <= 36;
+        if (ok) entry.chamber = MuonChamberIndex::csc(a, b, c, d);
+      }
+      if (ok && theIOVs.empty())
+        throw runtime_error("MuonTimeCalibration: offset before the first iov in " + fileName);
+      if (ok) theIOVs.back().entries.push_back(entry);
+    }
+    if (!ok) {
+      ostringstream message;
+      message << "MuonTimeCalibration: bad line " << nLine << " in " << fileName;
+      throw runtime_error(message.str());
+    }
+  }
+
+  stable_sort(theIOVs.begin(), theIOVs.end(), [](const IOV& a, const IOV& b) { return a.firstRun < b.firstRun; });
+  // empty run range: the first update() loads the offsets
+  theFirstRun = 1;
+  theLastRun = 0;
+}
+
+bool MuonTimeCalibration::update(unsigned int run) {
+  if (run >= theFirstRun && run <= theLastRun) return false;
+
+  // last IOV starting at or before the run
+  vector<IOV>::const_iterator next = upper_bound(theIOVs.begin(), theIOVs.end(), run,
+                                                 [](unsigned int r, const IOV& iov) { return r < iov.firstRun; });
+  fill(theOffsets.begin(), theOffsets.end(), 0.f);
+  theNCurrent = 0;
+  theFirstRun = next == theIOVs.begin() ? 0 : (next-1)->firstRun;
+  theLastRun = next == theIOVs.end() ? UINT_MAX : next->firstRun - 1;
+  if (next == theIOVs.begin()) return true;
+
+  for (const Entry& entry : (next-1)->entries) theOffsets[entry.chamber] = entry.offset;
+  theNCurrent = (next-1)->entries.size();
+  return true;
+}
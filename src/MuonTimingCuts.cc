@@ -0,0 +1,156 @@
+#include "UserCode/HSCPTOF/interface/MuonTimingCuts.h"
+
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  // same order as the names in MuonTimingCuts::variableNames()
+  enum Variable {
+    Pt, Eta, Phi, IsGlobal, IsTracker, IsStandAlone, IsPF, IsGlbPromptTight, IsLoose, IsTight, NStations,
+    RpcNdof, RpcTime, RpcTimeErr, CmbNdof, CmbTime, CmbTimeErr,
+    DtNdof, DtTime, DtTimeErr, CscNdof, CscTime, CscTimeErr, TimeOk,
+    NVariables
+  };
+
+  // the predefined requireId values
+  string expressionFor(const string& idCut) {
+    if (idCut=="glb")    return "isGlbPromptTight";
+    if (idCut=="loose")  return "isLoose";
+    if (idCut=="tight")  return "isTight";
+    if (idCut=="norpc")  return "rpcNdof<=1";
+    if (idCut=="norpc3") return "!(rpcNdof>1 && rpcTimeErr==0)";
+    if (idCut=="timeok") return "timeOk";
+    return idCut;
+  }
+}
+
+const vector<string>& MuonTimingCuts::variableNames() {
+  static const vector<string> names = {
+    "pt", "eta", "phi", "isGlobal", "isTracker", "isStandAlone", "isPF", "isGlbPromptTight", "isLoose", "isTight", "nStations",
+    "rpcNdof", "rpcTime", "rpcTimeErr", "cmbNdof", "cmbTime", "cmbTimeErr",
+    "dtNdof", "dtTime", "dtTimeErr", "cscNdof", "cscTime", "cscTimeErr", "timeOk"
+  };
+  return names;
+}
+
+const vector<string>& MuonTimingCuts::embeddedTimeVariables() {
+  static const vector<string> names = [] {
+    vector<string> v(variableNames().begin(), variableNames().begin() + DtNdof);
+    v.push_back(variableNames()[TimeOk]);
+    return v;
+  }();
+  return names;
+}
+
+MuonTimingCuts::MuonTimingCuts(double ptCut, double etaMin, double etaMax, const string& idCut,
+                               const vector<string>& available)
+  : thePtCut(ptCut),
+    theMinEta(etaMin),
+    theMaxEta(etaMax),
+    theSelection(expressionFor(idCut), variableNames())
+{
+  for (unsigned int i = 0; i < NVariables; i++) {
+    if (!theSelection.used(i)) continue;
+    const string& name = variableNames()[i];
+    if (find(available.begin(), available.end(), name) == available.end())
+      throw cms::Exception("Configuration") << "MuonTimingCuts: \"" << theSelection.expression() << "\" uses "
+                                            << name << ", which is not available in this module";
+    theUsedVariables.push_back(i);
+  }
+}
+
+reco::MuonTime MuonTimingCuts::rpcTime(const reco::Muon& mu) {
+  reco::MuonTime rpc = mu.rpcTime();
+  if (rpc.timeAtIpInOut<-60 || rpc.timeAtIpInOut>80) rpc.nDof=0;
+  return rpc;
+}
+
+bool MuonTimingCuts::timeOk(const reco::MuonTime& rpc, int cmbNDof, double cmbTime) {
+  if (rpc.nDof>1 && rpc.timeAtIpInOutErr<1) return fabs(rpc.timeAtIpInOut)<=20;
+  return !(cmbNDof>4 && (cmbTime>20 || cmbTime<-50));
+}
+
+MuonTimingCuts::MuonTimeInfo MuonTimingCuts::timeInfo(const reco::Muon& mu) {
+  MuonTimeInfo times;
+  times.rpc = rpcTime(mu);
+  times.cmbNDof = mu.time().nDof;
+  times.cmbTime = mu.time().timeAtIpInOut;
+  times.cmbTimeErr = mu.time().timeAtIpInOutErr;
+  times.dtNDof = times.cscNDof = 0;
+  times.dtTime = times.dtTimeErr = times.cscTime = times.cscTimeErr = 0;
+  times.timeOk = timeOk(times.rpc, times.cmbNDof, times.cmbTime);
+  return times;
+}
+
+MuonTimingCuts::MuonTimeInfo MuonTimingCuts::timeInfo(const reco::Muon& mu, const reco::MuonTimeExtra& cmb,
+                                                      const reco::MuonTimeExtra& dt, const reco::MuonTimeExtra& csc) {
+  MuonTimeInfo times;
+  times.rpc = rpcTime(mu);
+  times.cmbNDof = cmb.nDof();
+  times.cmbTime = cmb.timeAtIpInOut();
+  times.cmbTimeErr = cmb.timeAtIpInOutErr();
+  times.dtNDof = dt.nDof();
+  times.dtTime = dt.timeAtIpInOut();
+  times.dtTimeErr = dt.timeAtIpInOutErr();
+  times.cscNDof = csc.nDof();
+  times.cscTime = csc.timeAtIpInOut();
+  times.cscTimeErr = csc.timeAtIpInOutErr();
+  times.timeOk = timeOk(times.rpc, times.cmbNDof, cmb.timeAtIpInOut());
+  return times;
+}
+
+bool MuonTimingCuts::passKinematics(const reco::Muon& mu) const {
+  if (mu.pt()<thePtCut) return false;
+  double eta = fabs(mu.eta());
+  return eta>=theMinEta && eta<=theMaxEta;
+}
+
+bool MuonTimingCuts::passId(const reco::Muon& mu, const MuonTimeInfo& times, const reco::Vertex* vtx) const {
+  if (theSelection.empty()) return true;
+  double vars[NVariables];
+  for (unsigned int i : theUsedVariables) vars[i] = variable(i, mu, times, vtx);
+  return theSelection(vars);
+}
+
+double MuonTimingCuts::variable(unsigned int i, const reco::Muon& mu, const MuonTimeInfo& times,
+                                const reco::Vertex* vtx) {
+  switch (i) {
+  case Pt:               return mu.pt();
+  case Eta:              return mu.eta();
+  case Phi:              return mu.phi();
+  case IsGlobal:         return mu.isGlobalMuon();
+  case IsTracker:        return mu.isTrackerMuon();
+  case IsStandAlone:     return mu.isStandAloneMuon();
+  case IsPF:             return mu.isPFMuon();
+  case IsGlbPromptTight: return muon::isGoodMuon(mu, muon::GlobalMuonPromptTight);
+  case IsLoose:          return muon::isLooseMuon(mu);
+  case IsTight:
+    if (vtx) return muon::isTightMuon(mu, *vtx);
+    // muon::isTightMuon without the dxy/dz cuts
+    if (!mu.isPFMuon() || !mu.isGlobalMuon()) return false;
+    return muon::isGoodMuon(mu, muon::GlobalMuonPromptTight) && mu.numberOfMatchedStations()>1
+        && mu.innerTrack()->hitPattern().trackerLayersWithMeasurement()>5
+        && mu.innerTrack()->hitPattern().numberOfValidPixelHits()>0;
+  case NStations:        return mu.numberOfMatchedStations();
+  case RpcNdof:          return times.rpc.nDof;
+  case RpcTime:          return times.rpc.timeAtIpInOut;
+  case RpcTimeErr:       return times.rpc.timeAtIpInOutErr;
+  case CmbNdof:          return times.cmbNDof;
+  case CmbTime:          return times.cmbTime;
+  case CmbTimeErr:       return times.cmbTimeErr;
+  case DtNdof:           return times.dtNDof;
+  case DtTime:           return times.dtTime;
+  case DtTimeErr:        return times.dtTimeErr;
+  case CscNdof:          return times.cscNDof;
+  case CscTime:          return times.cscTime;
+  case CscTimeErr:       return times.cscTimeErr;
+  case TimeOk:           return times.timeOk;
+  default:               return 0;
+  }
+}
@@ -0,0 +1,217 @@
+#include "UserCode/HSCPTOF/interface/PhaseTimer.h"
+#include "UserCode/HSCPTOF/interface/HardwareCounters.h"
+
+#include <TH1F.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+PhaseTimer::PhaseTimer(const string& name, const vector<string>& phases, bool enabled, unsigned int nSlowest,
+                       bool counters)
+  : theName(name),
+    thePhases(phases),
+    theEnabled(enabled),
+    theNSlowest(nSlowest),
+    theOpen(false),
+    theCurrent(phases.size(), 0.),
+    theEvents(0),
+    theTotals(phases.size() + 1, 0.),
+    theMax(phases.size() + 1, 0.),
+    theCounts(phases.size() + 1, vector<unsigned long long>((theMaxDecade - theMinDecade) * theBinsPerDecade + 2, 0))
+{
+  if (enabled && counters) {
+    theCounters.reset(new HardwareCounters);
+    theLastCount.assign(HardwareCounters::nCounters, 0);
+    theCurrentCounts.assign(phases.size() * HardwareCounters::nCounters, 0);
+    theTotalCounts.assign(phases.size() * HardwareCounters::nCounters, 0);
+  }
+}
+
+PhaseTimer::~PhaseTimer() {}
+
+int PhaseTimer::bin(double seconds) {
+  const int nBins = (theMaxDecade - theMinDecade) * theBinsPerDecade;
+  if (seconds <= 0) return 0;
+  double x = (log10(seconds) - theMinDecade) * theBinsPerDecade;
+  if (x < 0) return 0;
+  if (x >= nBins) return nBins + 1;
+  return int(x) + 1;
+}
+
+void PhaseTimer::startEvent(unsigned int run, unsigned int lumi, unsigned long long event) {
+  if (!theEnabled) return;
+  finish();
+  theOpen = true;
+  theEvent.run = run;
+  theEvent.lumi = lumi;
+  theEvent.event = event;
+  theEvent.nMuons = theEvent.nTP = theEvent.nSegments = 0;
+  fill(theCurrent.begin(), theCurrent.end(), 0.);
+  if (theCounters) {
+    // the framework may run the next event on another thread
+    if (theCounters->thread() != this_thread::get_id()) theCounters->open();
+    fill(theCurrentCounts.begin(), theCurrentCounts.end(), 0);
+    theCounters->read(&theLastCount[0]);
+  }
+  theLast = Clock::now();
+}
+
+void PhaseTimer::count(unsigned int phase) {
+  unsigned long long now[HardwareCounters::nCounters];
+  theCounters->read(now);
+  for (int i = 0; i < HardwareCounters::nCounters; i++) {
+    theCurrentCounts[phase * HardwareCounters::nCounters + i] += now[i] - theLastCount[i];
+    theLastCount[i] = now[i];
+  }
+}
+
+void PhaseTimer::setSizes(unsigned int nMuons, unsigned int nTP, unsigned int nSegments) {
+  theEvent.nMuons = nMuons;
+  theEvent.nTP = nTP;
+  theEvent.nSegments = nSegments;
+}
+
+void PhaseTimer::finish() {
+  if (!theOpen) return;
+  theOpen = false;
+  theEvents++;
+
+  // the event time is the sum of the marked phases, the time after the last mark is not counted
+  const unsigned int n = thePhases.size();
+  double total = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    double t = theCurrent[i];
+    total += t;
+    theTotals[i] += t;
+    theMax[i] = max(theMax[i], t);
+    if (t > 0) theCounts[i][bin(t)]++;
+  }
+  theTotals[n] += total;
+  theMax[n] = max(theMax[n], total);
+  theCounts[n][bin(total)]++;
+  for (unsigned int i = 0; i < theCurrentCounts.size(); i++) theTotalCounts[i] += theCurrentCounts[i];
+
+  if (!theNSlowest) return;
+  if (theSlowest.size() == theNSlowest && total <= theSlowest.front().total) return;
+  theEvent.total = total;
+  theEvent.phases = theCurrent;
+  auto greater = [](const EventRecord& a, const EventRecord& b) { return a.total > b.total; };
+  if (theSlowest.size() == theNSlowest) {
+    pop_heap(theSlowest.begin(), theSlowest.end(), greater);
+    theSlowest.back() = theEvent;
+  } else theSlowest.push_back(theEvent);
+  push_heap(theSlowest.begin(), theSlowest.end(), greater);
+}
+
+TH1F* PhaseTimer::histogram(unsigned int phase) const {
+  const int nBins = (theMaxDecade - theMinDecade) * theBinsPerDecade;
+  string label = phase < thePhases.size() ? thePhases[phase] : "event";
+  string name = "hi_time_" + label;
+  replace(name.begin(), name.end(), ' ', '_');
+  TH1F* h = new TH1F(name.c_str(), (theName + " " + label + " time;log_{10}(t/s);Events").c_str(),
+                     nBins, theMinDecade, theMaxDecade);
+  h->SetDirectory(0);
+  const vector<unsigned long long>& counts = theCounts[phase];
+  unsigned long long entries = 0;
+  for (int i = 0; i < nBins + 2; i++) {
+    h->SetBinContent(i, counts[i]);
+    entries += counts[i];
+  }
+  h->SetEntries(entries);
+  return h;
+}
+
+double PhaseTimer::quantile(const vector<unsigned long long>& counts, double q) const {
+  unsigned long long n = 0;
+  for (unsigned long long c : counts) n += c;
+  if (!n) return 0;
+  unsigned long long sum = 0;
+  for (unsigned int i = 0; i < counts.size(); i++) {
+    sum += counts[i];
+    // upper edge of the bin
+    if (sum >= q * n) return pow(10., theMinDecade + double(i) / theBinsPerDecade);
+  }
+  return pow(10., theMaxDecade);
+}
+
+void PhaseTimer::print(ostream& out) const {
+  if (!theEnabled) return;
+  const unsigned int n = thePhases.size();
+  unsigned int width = 8;
+  for (const string& p : thePhases) width = max<unsigned int>(width, p.size());
+
+  ios_base::fmtflags flags = out.flags();
+  out << " Phase timing " << theName << " (" << theEvents << " events, ms; median and 99% from the histogram bin upper edges):" << endl;
+  out << "   " << left << setw(width) << "phase" << right << setw(12) << "total [s]" << setw(10) << "mean"
+      << setw(10) << "median" << setw(10) << "99%" << setw(10) << "max" << endl;
+  for (unsigned int i = 0; i <= n; i++) {
+    double mean = theEvents ? theTotals[i] / theEvents : 0;
+    out << "   " << left << setw(width) << (i < n ? thePhases[i] : string("event")) << right << fixed
+        << setprecision(3) << setw(12) << theTotals[i] << setw(10) << 1e3 * mean
+        << setw(10) << 1e3 * min(quantile(theCounts[i], 0.5), theMax[i])
+        << setw(10) << 1e3 * min(quantile(theCounts[i], 0.99), theMax[i])
+        << setw(10) << 1e3 * theMax[i] << endl;
+  }
+
+  vector<EventRecord> slowest(theSlowest);
+  sort(slowest.begin(), slowest.end(), [](const EventRecord& a, const EventRecord& b) { return a.total > b.total; });
+  if (!slowest.empty()) {
+    out << " Slowest events " << theName << " (run:lumi:event muons TPs segments, total and per phase in ms):" << endl;
+    for (const EventRecord& e : slowest) {
+      out << "   " << e.run << ":" << e.lumi << ":" << e.event << "  " << e.nMuons << " " << e.nTP << " "
+          << e.nSegments << "  " << setprecision(3) << 1e3 * e.total << " ms:";
+      for (unsigned int i = 0; i < n; i++) out << " " << thePhases[i] << " " << 1e3 * e.phases[i];
+      out << endl;
+    }
+  }
+  out.flags(flags);
+  if (theCounters) printCounters(out);
+}
+
+void PhaseTimer::printCounters(ostream& out) const {
+  const int nc = HardwareCounters::nCounters;
+  const unsigned int n = thePhases.size();
+  unsigned int width = 8;
+  for (const string& p : thePhases) width = max<unsigned int>(width, p.size());
+  const double events = max(1ULL, theEvents);
+
+  ios_base::fmtflags flags = out.flags();
+  out << fixed << setprecision(0);
+  vector<unsigned long long> sum(nc, 0);
+  for (unsigned int i = 0; i < n; i++)
+    for (int k = 0; k < nc; k++) sum[k] += theTotalCounts[i * nc + k];
+
+  if (!theCounters->hardware()) {
+    out << " Thread CPU time " << theName << " per event (us; no access to the hardware counters):" << endl;
+    for (unsigned int i = 0; i <= n; i++) {
+      unsigned long long ns = i < n ? theTotalCounts[i * nc + HardwareCounters::cycles] : sum[HardwareCounters::cycles];
+      out << "   " << left << setw(width) << (i < n ? thePhases[i] : string("event")) << right << setw(12)
+          << ns / events / 1e3 << endl;
+    }
+    out.flags(flags);
+    return;
+  }
+
+  out << " Hardware counters " << theName << " per event (" << theEvents << " events, user space):" << endl;
+  out << "   " << left << setw(width) << "phase" << right;
+  for (int k = 0; k < nc; k++) out << setw(15) << HardwareCounters::name(k);
+  out << setw(8) << "IPC" << endl;
+  for (unsigned int i = 0; i <= n; i++) {
+    const unsigned long long* c = i < n ? &theTotalCounts[i * nc] : &sum[0];
+    out << "   " << left << setw(width) << (i < n ? thePhases[i] : string("event")) << right;
+    for (int k = 0; k < nc; k++) {
+      if (theCounters->available(k)) out << setw(15) << c[k] / events;
+        else out << setw(15) << "-";
+    }
+    out << setprecision(2) << setw(8) << (c[HardwareCounters::cycles] ? double(c[HardwareCounters::instructions]) / c[HardwareCounters::cycles] : 0.)
+        << setprecision(0) << endl;
+  }
+  out << "   " << left << setw(width) << "job" << right;
+  for (int k = 0; k < nc; k++) out << setw(15) << (double)sum[k];
+  out << endl;
+  out.flags(flags);
+}
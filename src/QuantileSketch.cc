@@ -0,0 +1,128 @@
+#include "UserCode/HSCPTOF/interface/QuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+QuantileSketch::QuantileSketch(unsigned int k)
+  : theK(max(k, 8u)),
+    theN(0),
+    theLevels(1),
+    theSize(0),
+    theRandom(2463534242u)
+{
+  updateCapacity();
+}
+
+QuantileSketch::QuantileSketch(unsigned int k, unsigned long long n, const vector<float>& items,
+                               const vector<unsigned int>& levelSizes)
+  : theK(max(k, 8u)),
+    theN(n),
+    theLevels(max((size_t)1, levelSizes.size())),
+    theSize(0),
+    theRandom(2463534242u)
+{
+  vector<float>::const_iterator it = items.begin();
+  for (unsigned int h = 0; h < levelSizes.size(); h++) {
+    if (items.end() - it < (ptrdiff_t)levelSizes[h]) throw invalid_argument("QuantileSketch: level sizes exceed the items");
+    theLevels[h].assign(it, it + levelSizes[h]);
+    it += levelSizes[h];
+    theSize += levelSizes[h];
+  }
+  updateCapacity();
+  while (theSize >= theCapacity) compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  // the level capacities and the error depend on k
+  if (other.theK != theK)
+    throw invalid_argument("QuantileSketch: cannot merge a sketch of k=" + to_string(other.theK) +
+                           " into one of k=" + to_string(theK));
+  if (other.theLevels.size() > theLevels.size()) theLevels.resize(other.theLevels.size());
+  for (unsigned int h = 0; h < other.theLevels.size(); h++)
+    theLevels[h].insert(theLevels[h].end(), other.theLevels[h].begin(), other.theLevels[h].end());
+  theN += other.theN;
+  theSize += other.theSize;
+  updateCapacity();
+  while (theSize >= theCapacity) compress();
+}
+
+float QuantileSketch::quantile(double q) const {
+  if (!theSize) return 0;
+  vector<pair<float,unsigned long long> > weighted;
+  weighted.reserve(theSize);
+  unsigned long long total = 0;
+  for (unsigned int h = 0; h < theLevels.size(); h++)
+    for (float x : theLevels[h]) {
+      weighted.push_back(make_pair(x, 1ULL << h));
+      total += 1ULL << h;
+    }
+  sort(weighted.begin(), weighted.end());
+
+  double target = min(max(q, 0.), 1.) * total;
+  unsigned long long below = 0;
+  for (const auto& w : weighted) {
+    below += w.second;
+    if (below >= target) return w.first;
+  }
+  return weighted.back().first;
+}
+
+size_t QuantileSketch::bytes() const {
+  size_t n = sizeof(*this) + theLevels.capacity() * sizeof(vector<float>);
+  for (const auto& level : theLevels) n += level.capacity() * sizeof(float);
+  return n;
+}
+
+void QuantileSketch::serialize(vector<float>& items, vector<unsigned int>& levelSizes) const {
+  items.clear();
+  levelSizes.clear();
+  for (const auto& level : theLevels) {
+    items.insert(items.end(), level.begin(), level.end());
+    levelSizes.push_back(level.size());
+  }
+}
+
+// k (2/3)^(depth), at least 2
+unsigned int QuantileSketch::capacity(unsigned int level) const {
+  unsigned int depth = theLevels.size() - 1 - level;
+  return max(2u, (unsigned int)ceil(theK * pow(2./3., (double)depth)));
+}
+
+void QuantileSketch::updateCapacity() {
+  theCapacity = 0;
+  for (unsigned int h = 0; h < theLevels.size(); h++) theCapacity += capacity(h);
+}
+
+// compact the lowest full level into the next one
+void QuantileSketch::compress() {
+  unsigned int h = 0;
+  while (h < theLevels.size() && theLevels[h].size() < capacity(h)) h++;
+  if (h == theLevels.size()) return;
+  if (h + 1 == theLevels.size()) {
+    theLevels.push_back(vector<float>());
+    updateCapacity();
+  }
+
+  vector<float>& level = theLevels[h];
+  vector<float>& up = theLevels[h + 1];
+  sort(level.begin(), level.end());
+  theRandom ^= theRandom << 13;
+  theRandom ^= theRandom >> 17;
+  theRandom ^= theRandom << 5;
+  // an odd item stays at this level, the smallest or the largest by a second coin,
+  // so that neither end of the distribution is favoured
+  size_t begin = 0, end = level.size();
+  bool odd = level.size() % 2;
+  float kept = 0;
+  if (odd && (theRandom & 2)) kept = level[--end];
+    else if (odd) kept = level[begin++];
+  for (size_t i = begin + (theRandom & 1); i < end; i += 2) up.push_back(level[i]);
+  theSize -= (end - begin) / 2;
+  level.clear();
+  if (odd) level.push_back(kept);
+  // a level that used to be the top one keeps a k-sized buffer otherwise
+  if (level.capacity() > 2 * capacity(h)) vector<float>(level).swap(level);
+}
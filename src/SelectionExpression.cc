@@ -0,0 +1,205 @@
+#include "UserCode/HSCPTOF/interface/SelectionExpression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+// recursive descent parser, each rule appends its operands and then its operator
+class SelectionExpression::Parser {
+public:
+  Parser(const string& text, const vector<string>& variables, vector<Op>& program, vector<bool>& used)
+    : theText(text), theVariables(variables), theProgram(program), theUsed(used), thePos(0) {}
+
+  void parse() {
+    skipSpace();
+    if (thePos == theText.size()) return;
+    parseOr();
+    if (thePos != theText.size()) error("unexpected '" + theText.substr(thePos, 1) + "'");
+  }
+
+private:
+  // the <cctype> functions need a non-negative value
+  static bool isSpace(char c) { return isspace((unsigned char)c); }
+  static bool isDigit(char c) { return isdigit((unsigned char)c); }
+  static bool isAlpha(char c) { return isalpha((unsigned char)c); }
+  static bool isAlnum(char c) { return isalnum((unsigned char)c); }
+
+  void skipSpace() { while (thePos < theText.size() && isSpace(theText[thePos])) thePos++; }
+
+  // consume the token tok if it comes next (and is not the start of a longer operator)
+  bool accept(const char* tok) {
+    size_t n = char_traits<char>::length(tok);
+    if (theText.compare(thePos, n, tok) != 0) return false;
+    if (n == 1 && thePos + 1 < theText.size() && theText[thePos + 1] == '=' && string("<>!=").find(tok[0]) != string::npos)
+      return false;
+    thePos += n;
+    skipSpace();
+    return true;
+  }
+
+  void expect(const char* tok) {
+    if (!accept(tok)) error(string("expected '") + tok + "'");
+  }
+
+  void emit(OpCode code, double value = 0) { theProgram.push_back(Op{code, value}); }
+
+  void parseOr() {
+    parseAnd();
+    while (accept("||")) { parseAnd(); emit(Or); }
+  }
+
+  void parseAnd() {
+    parseEquality();
+    while (accept("&&")) { parseEquality(); emit(And); }
+  }
+
+  // == and != bind more loosely than the relational operators, as in C
+  void parseEquality() {
+    parseRelation();
+    for (;;) {
+      if (accept("==")) { parseRelation(); emit(Eq); }
+      else if (accept("!=")) { parseRelation(); emit(Ne); }
+      else return;
+    }
+  }
+
+  void parseRelation() {
+    parseSum();
+    static const char* ops[] = {"<=", ">=", "<", ">"};
+    static const OpCode codes[] = {Le, Ge, Lt, Gt};
+    for (;;) {
+      int i = 0;
+      while (i < 4 && !accept(ops[i])) i++;
+      if (i == 4) return;
+      parseSum();
+      emit(codes[i]);
+    }
+  }
+
+  void parseSum() {
+    parseProduct();
+    for (;;) {
+      if (accept("+")) { parseProduct(); emit(Add); }
+      else if (accept("-")) { parseProduct(); emit(Sub); }
+      else return;
+    }
+  }
+
+  void parseProduct() {
+    parseUnary();
+    for (;;) {
+      if (accept("*")) { parseUnary(); emit(Mul); }
+      else if (accept("/")) { parseUnary(); emit(Div); }
+      else return;
+    }
+  }
+
+  void parseUnary() {
+    if (accept("-")) { parseUnary(); emit(Neg); return; }
+    if (accept("!")) { parseUnary(); emit(Not); return; }
+    parsePrimary();
+  }
+
+  void parsePrimary() {
+    if (accept("(")) {
+      parseOr();
+      expect(")");
+      return;
+    }
+    if (thePos == theText.size()) error("unexpected end");
+
+    char c = theText[thePos];
+    if (isDigit(c) || c == '.') {
+      const char* begin = theText.c_str() + thePos;
+      char* end = 0;
+      double value = strtod(begin, &end);
+      if (end == begin) error("bad number");
+      thePos += end - begin;
+      skipSpace();
+      emit(Const, value);
+      return;
+    }
+
+    if (isAlpha(c) || c == '_') {
+      size_t begin = thePos;
+      while (thePos < theText.size() && (isAlnum(theText[thePos]) || theText[thePos] == '_')) thePos++;
+      string name = theText.substr(begin, thePos - begin);
+      skipSpace();
+      if (name == "abs") {
+        expect("(");
+        parseOr();
+        expect(")");
+        emit(Abs);
+        return;
+      }
+      for (unsigned int i = 0; i < theVariables.size(); i++)
+        if (theVariables[i] == name) {
+          theUsed[i] = true;
+          emit(Var, i);
+          return;
+        }
+      thePos = begin;
+      error("unknown variable '" + name + "'");
+    }
+
+    error("unexpected '" + string(1, c) + "'");
+  }
+
+  void error(const string& what) const {
+    throw invalid_argument("SelectionExpression: " + what + " at position " + to_string(thePos) +
+                           " in \"" + theText + "\"");
+  }
+
+  const string& theText;
+  const vector<string>& theVariables;
+  vector<Op>& theProgram;
+  vector<bool>& theUsed;
+  size_t thePos;
+};
+
+
+SelectionExpression::SelectionExpression(const string& expression, const vector<string>& variables)
+  : theExpression(expression),
+    theUsed(variables.size(), false)
+{
+  Parser(theExpression, variables, theProgram, theUsed).parse();
+
+  // the evaluation stack is a fixed array
+  unsigned int depth = 0;
+  for (const Op& op : theProgram) {
+    if (op.code == Const || op.code == Var) depth++;
+    else if (op.code != Neg && op.code != Not && op.code != Abs) depth--;
+    if (depth > theMaxDepth)
+      throw invalid_argument("SelectionExpression: too deeply nested \"" + theExpression + "\"");
+  }
+}
+
+double SelectionExpression::evaluate(const double* vars) const {
+  double stack[theMaxDepth];
+  int top = -1;
+  for (const Op& op : theProgram) {
+    switch (op.code) {
+    case Const: stack[++top] = op.value; break;
+    case Var:   stack[++top] = vars[int(op.value)]; break;
+    case Neg:   stack[top] = -stack[top]; break;
+    case Not:   stack[top] = stack[top] == 0.; break;
+    case Abs:   stack[top] = fabs(stack[top]); break;
+    case Add:   top--; stack[top] = stack[top] + stack[top + 1]; break;
+    case Sub:   top--; stack[top] = stack[top] - stack[top + 1]; break;
+    case Mul:   top--; stack[top] = stack[top] * stack[top + 1]; break;
+    case Div:   top--; stack[top] = stack[top] / stack[top + 1]; break;
+    case Lt:    top--; stack[top] = stack[top] < stack[top + 1]; break;
+    case Le:    top--; stack[top] = stack[top] <= stack[top + 1]; break;
+    case Gt:    top--; stack[top] = stack[top] > stack[top + 1]; break;
+    case Ge:    top--; stack[top] = stack[top] >= stack[top + 1]; break;
+    case Eq:    top--; stack[top] = stack[top] == stack[top + 1]; break;
+    case Ne:    top--; stack[top] = stack[top] != stack[top + 1]; break;
+    case And:   top--; stack[top] = stack[top] != 0. && stack[top + 1] != 0.; break;
+    case Or:    top--; stack[top] = stack[top] != 0. || stack[top + 1] != 0.; break;
+    }
+  }
+  return stack[0];
+}
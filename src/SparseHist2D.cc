@@ -0,0 +1,93 @@
+#include "UserCode/HSCPTOF/interface/SparseHist2D.h"
+
+#include <TH2.h>
+#include <THnSparse.h>
+
+SparseHist2D::SparseHist2D(const char* name, const char* title,
+                           int nbinsx, double xlow, double xup,
+                           int nbinsy, double ylow, double yup)
+  : theName(name), theTitle(title),
+    theNx(nbinsx), theNy(nbinsy),
+    theXlow(xlow), theXup(xup), theYlow(ylow), theYup(yup),
+    theNBlocksX((nbinsx + 2 + theBlockSize - 1) / theBlockSize),
+    theNBlocksY((nbinsy + 2 + theBlockSize - 1) / theBlockSize),
+    theBlocks(theNBlocksX * theNBlocksY),
+    theNAllocated(0)
+{
+  Reset();
+}
+
+void SparseHist2D::Reset() {
+  for (auto& block : theBlocks) block.reset();
+  theNAllocated = 0;
+  theEntries = 0;
+  theTsumw = theTsumw2 = theTsumwx = theTsumwx2 = theTsumwy = theTsumwy2 = theTsumwxy = 0;
+}
+
+TH2F* SparseHist2D::toTH2F() const {
+  TH2F* h = new TH2F(theName.c_str(), theTitle.c_str(), theNx, theXlow, theXup, theNy, theYlow, theYup);
+  h->SetDirectory(0);
+
+  for (int by = 0; by < theNBlocksY; by++)
+    for (int bx = 0; bx < theNBlocksX; bx++) {
+      const float* block = theBlocks[by * theNBlocksX + bx].get();
+      if (!block) continue;
+      for (int j = 0; j < theBlockSize; j++)
+        for (int i = 0; i < theBlockSize; i++) {
+          float content = block[j * theBlockSize + i];
+          if (content == 0) continue;
+          h->SetBinContent((bx << theBlockBits) + i, (by << theBlockBits) + j, content);
+        }
+    }
+
+  double stats[7] = {theTsumw, theTsumw2, theTsumwx, theTsumwx2, theTsumwy, theTsumwy2, theTsumwxy};
+  h->PutStats(stats);
+  h->SetEntries(theEntries);
+  return h;
+}
+
+THnSparseF* SparseHist2D::toTHnSparse() const {
+  int nbins[2] = {theNx, theNy};
+  double xmin[2] = {theXlow, theYlow};
+  double xmax[2] = {theXup, theYup};
+  THnSparseF* h = new THnSparseF(theName.c_str(), theTitle.c_str(), 2, nbins, xmin, xmax);
+
+  int coord[2];
+  for (int by = 0; by < theNBlocksY; by++)
+    for (int bx = 0; bx < theNBlocksX; bx++) {
+      const float* block = theBlocks[by * theNBlocksX + bx].get();
+      if (!block) continue;
+      for (int j = 0; j < theBlockSize; j++)
+        for (int i = 0; i < theBlockSize; i++) {
+          float content = block[j * theBlockSize + i];
+          if (content == 0) continue;
+          coord[0] = (bx << theBlockBits) + i;
+          coord[1] = (by << theBlockBits) + j;
+          h->SetBinContent(coord, content);
+        }
+    }
+
+  h->SetEntries(theEntries);
+  return h;
+}
+
+void SparseHist2D::Write(bool asTHnSparse) const {
+  if (asTHnSparse) {
+    THnSparseF* h = toTHnSparse();
+    h->Write();
+    delete h;
+  } else {
+    TH2F* h = toTH2F();
+    h->Write();
+    delete h;
+  }
+}
+
+size_t SparseHist2D::denseBytes() const {
+  return sizeof(TH2F) + size_t(theNx + 2) * (theNy + 2) * sizeof(float);
+}
+
+size_t SparseHist2D::sparseBytes() const {
+  return sizeof(SparseHist2D) + theBlocks.size() * sizeof(theBlocks[0])
+    + size_t(theNAllocated) * theBlockSize * theBlockSize * sizeof(float);
+}
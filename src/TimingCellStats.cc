@@ -0,0 +1,140 @@
+#include "UserCode/HSCPTOF/interface/TimingCellStats.h"
+
+#include <TTree.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+TimingCellStats::TimingCellStats(unsigned int nCells, unsigned int k)
+  : theK(k),
+    theMoments(nCells),
+    theSketches(nCells, QuantileSketch(k))
+{
+}
+
+void TimingCellStats::resize(unsigned int nCells) {
+  theMoments.resize(nCells);
+  theSketches.resize(nCells, QuantileSketch(theK));
+}
+
+void TimingCellStats::merge(const TimingCellStats& other) {
+  if (other.theK != theK)
+    throw invalid_argument("TimingCellStats: cannot merge statistics of k=" + to_string(other.theK) +
+                           " into ones of k=" + to_string(theK));
+  if (other.size() > size()) resize(other.size());
+  for (unsigned int i = 0; i < other.size(); i++) {
+    theMoments[i].merge(other.theMoments[i]);
+    theSketches[i].merge(other.theSketches[i]);
+  }
+  if (other.theLabels.size() > theLabels.size()) theLabels.resize(other.theLabels.size());
+  for (unsigned int i = 0; i < other.theLabels.size(); i++)
+    if (theLabels[i].empty()) theLabels[i] = other.theLabels[i];
+}
+
+size_t TimingCellStats::bytes() const {
+  size_t n = theMoments.capacity() * sizeof(TimingMoments);
+  for (const QuantileSketch& sketch : theSketches) n += sketch.bytes();
+  return n;
+}
+
+TTree* TimingCellStats::table(const char* name, const char* title, const function<string(int)>& label) const {
+  int cell;
+  char text[32];
+  ULong64_t n;
+  double mean, m2;
+  float rms, q16, q50, q84;
+  unsigned int k = theK;
+  vector<float> items, *pItems = &items;
+  vector<unsigned int> levels, *pLevels = &levels;
+
+  TTree* tree = new TTree(name, title);
+  tree->Branch("cell", &cell, "cell/I");
+  tree->Branch("label", text, "label/C");
+  tree->Branch("n", &n, "n/l");
+  tree->Branch("mean", &mean, "mean/D");
+  tree->Branch("rms", &rms, "rms/F");
+  tree->Branch("q16", &q16, "q16/F");
+  tree->Branch("q50", &q50, "q50/F");
+  tree->Branch("q84", &q84, "q84/F");
+  // state for the merging
+  tree->Branch("m2", &m2, "m2/D");
+  tree->Branch("k", &k, "k/i");
+  tree->Branch("items", &pItems);
+  tree->Branch("levels", &pLevels);
+
+  for (cell = 0; cell < (int)size(); cell++) {
+    const TimingMoments& moments = theMoments[cell];
+    if (!moments.n) continue;
+    const QuantileSketch& sketch = theSketches[cell];
+    strncpy(text, (label ? label(cell) : this->label(cell)).c_str(), sizeof(text) - 1);
+    text[sizeof(text) - 1] = 0;
+    n = moments.n;
+    mean = moments.mean;
+    m2 = moments.m2;
+    rms = moments.rms();
+    q16 = sketch.quantile(0.16);
+    q50 = sketch.quantile(0.5);
+    q84 = sketch.quantile(0.84);
+    sketch.serialize(items, levels);
+    tree->Fill();
+  }
+  return tree;
+}
+
+bool TimingCellStats::addTable(TTree* tree) {
+  if (!tree || !tree->GetBranch("cell") || !tree->GetBranch("n") || !tree->GetBranch("m2")
+      || !tree->GetBranch("k") || !tree->GetBranch("items") || !tree->GetBranch("levels")) return false;
+
+  int cell;
+  char text[32] = "";
+  ULong64_t n;
+  double mean, m2;
+  unsigned int k;
+  vector<float>* items = 0;
+  vector<unsigned int>* levels = 0;
+  tree->SetBranchAddress("cell", &cell);
+  if (tree->GetBranch("label")) tree->SetBranchAddress("label", text);
+  tree->SetBranchAddress("n", &n);
+  tree->SetBranchAddress("mean", &mean);
+  tree->SetBranchAddress("m2", &m2);
+  tree->SetBranchAddress("k", &k);
+  tree->SetBranchAddress("items", &items);
+  tree->SetBranchAddress("levels", &levels);
+
+  // all the rows are checked before any is merged; k = 0 takes the k of the first row
+  TBranch* kBranch = tree->GetBranch("k");
+  for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+    kBranch->GetEntry(i);
+    if (!theK) {
+      theK = k;
+      for (QuantileSketch& sketch : theSketches) sketch = QuantileSketch(theK);
+    }
+    if (k != theK) {
+      tree->ResetBranchAddresses();
+      delete items;
+      delete levels;
+      throw invalid_argument("TimingCellStats: " + string(tree->GetName()) + " was written with k=" + to_string(k) +
+                             ", not k=" + to_string(theK));
+    }
+  }
+
+  for (Long64_t i = 0; i < tree->GetEntries(); i++) {
+    tree->GetEntry(i);
+    if (cell < 0) continue;
+    if ((unsigned int)cell >= size()) resize(cell + 1);
+    TimingMoments moments;
+    moments.n = n;
+    moments.mean = mean;
+    moments.m2 = m2;
+    theMoments[cell].merge(moments);
+    theSketches[cell].merge(QuantileSketch(k, n, *items, *levels));
+    if ((unsigned int)cell >= theLabels.size()) theLabels.resize(cell + 1);
+    if (theLabels[cell].empty()) theLabels[cell] = text;
+  }
+  tree->ResetBranchAddresses();
+  delete items;
+  delete levels;
+  return true;
+}
@@ -0,0 +1,44 @@
+#include "UserCode/HSCPTOF/interface/TimingCutScan.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+TimingCutScan::TimingCutScan(unsigned int nCuts, unsigned int nDofCuts)
+  : theNCuts(nCuts),
+    theNDofCuts(nDofCuts),
+    theCorners((nCuts + 1) * (nDofCuts + 1), 0)
+{
+}
+
+void TimingCutScan::fill(float time, int nDof) {
+  // |t| > i holds for i < ceil|t|; false for a NaN time
+  float t = fabs(time);
+  unsigned int i = 0;
+  if (t > 0) i = t < theNCuts ? (unsigned int)ceil(t) : theNCuts;
+  unsigned int j = nDof > 0 ? ((unsigned int)nDof < theNDofCuts ? nDof : theNDofCuts) : 0;
+  if (i && j) theCorners[i * (theNDofCuts + 1) + j]++;
+}
+
+unsigned long long TimingCutScan::count(unsigned int i, unsigned int j) const {
+  unsigned long long n = 0;
+  for (unsigned int ci = i + 1; ci <= theNCuts; ci++)
+    for (unsigned int cj = j + 1; cj <= theNDofCuts; cj++)
+      n += theCorners[ci * (theNDofCuts + 1) + cj];
+  return n;
+}
+
+unsigned long long TimingCutScan::entries() const {
+  unsigned long long n = 0;
+  for (unsigned int ci = 1; ci <= theNCuts; ci++)
+    for (unsigned int cj = 1; cj <= theNDofCuts; cj++)
+      n += (unsigned long long)ci * cj * theCorners[ci * (theNDofCuts + 1) + cj];
+  return n;
+}
+
+void TimingCutScan::merge(const TimingCutScan& other) {
+  if (other.theNCuts != theNCuts || other.theNDofCuts != theNDofCuts)
+    throw runtime_error("TimingCutScan::merge: different cuts");
+  for (unsigned int k = 0; k < theCorners.size(); k++) theCorners[k] += other.theCorners[k];
+}
@@ -0,0 +1,159 @@
+#include "UserCode/HSCPTOF/interface/TimingFitter.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  typedef float v4sf __attribute__((vector_size(16)));
+  // same vector, for loads from float arrays without 16 byte alignment
+  typedef float v4sf_u __attribute__((vector_size(16), aligned(4)));
+
+  inline v4sf load(const float* p) { return *(const v4sf_u*)p; }
+  inline double hsum(v4sf v) { return double(v[0]) + v[1] + v[2] + v[3]; }
+
+  const float c = 30.;   // speed of light [cm/ns]
+}
+
+TimingFitter::TimingFitter(double outlierCut)
+  : theOutlierCut(outlierCut),
+    theNHits(0)
+{
+}
+
+void TimingFitter::clear() {
+  theNHits = 0;
+  theDist.clear();
+  theT0.clear();
+  theWeight.clear();
+  theMask.clear();
+}
+
+void TimingFitter::addHit(float dist, float t0, float err) {
+  if (dist <= 0 || err <= 0) return;
+  // overwrite the first padding slot, or open a new block of theWidth
+  if (theNHits == theDist.size()) {
+    theDist.resize(theNHits + theWidth, 1.);
+    theT0.resize(theNHits + theWidth, 0.);
+    theWeight.resize(theNHits + theWidth, 0.);
+    theMask.resize(theNHits + theWidth, 0.);
+  }
+  theDist[theNHits] = dist;
+  theT0[theNHits] = t0;
+  theWeight[theNHits] = 1. / (err * err);
+  theMask[theNHits] = 1.;
+  theNHits++;
+}
+
+void TimingFitter::removeHit(unsigned int i) {
+  unsigned int last = theNHits - 1;
+  theDist[i] = theDist[last];
+  theT0[i] = theT0[last];
+  theWeight[i] = theWeight[last];
+  theMask[i] = theMask[last];
+  theDist[last] = 1.;
+  theT0[last] = 0.;
+  theWeight[last] = 0.;
+  theMask[last] = 0.;
+  theNHits--;
+}
+
+TimingFitResult TimingFitter::fit() {
+  TimingFitResult result = fitOnce();
+  if (theOutlierCut <= 0) return result;
+
+  while (theNHits > 2) {
+    // largest pull w.r.t. the in-out time at vertex
+    unsigned int worst = 0;
+    double maxPull2 = 0;
+    for (unsigned int i = 0; i < theNHits; i++) {
+      double diff = theT0[i] - result.timeAtIpInOut;
+      double pull2 = diff * diff * theWeight[i];
+      if (pull2 > maxPull2) {
+        maxPull2 = pull2;
+        worst = i;
+      }
+    }
+    if (maxPull2 < theOutlierCut * theOutlierCut) break;
+    removeHit(worst);
+    result = fitOnce();
+  }
+  return result;
+}
+
+TimingFitResult TimingFitter::fitOnce() const {
+  TimingFitResult result;
+  if (!theNHits) return result;
+
+  const unsigned int n = theDist.size();
+  const float* dist = theDist.data();
+  const float* t0 = theT0.data();
+  const float* weight = theWeight.data();
+  const float* mask = theMask.data();
+
+  // first pass: weighted means and the sums of the straight line fit
+  v4sf sWib = {0, 0, 0, 0}, sWibIb = sWib, sWt = sWib, sWtT = sWib, sWtTR = sWib;
+  v4sf sM = sWib, sX = sWib, sY = sWib, sXX = sWib, sXY = sWib;
+  for (unsigned int i = 0; i < n; i += theWidth) {
+    v4sf d = load(dist + i), t = load(t0 + i), w = load(weight + i), m = load(mask + i);
+    v4sf x = d / c;
+    v4sf ib = 1.f + t / x;
+    v4sf wib = x * x * w;
+    v4sf y = t + x;
+    sWib += wib;
+    sWibIb += wib * ib;
+    sWt += w;
+    sWtT += w * t;
+    sWtTR += w * (t + 2.f * x);
+    sM += m;
+    sX += m * x;
+    sY += m * y;
+    sXX += m * x * x;
+    sXY += m * x * y;
+  }
+
+  double totalWib = hsum(sWib), totalWt = hsum(sWt);
+  double invBeta = hsum(sWibIb) / totalWib;
+  double timeIO = hsum(sWtT) / totalWt;
+  double timeOI = hsum(sWtTR) / totalWt;
+
+  double s = hsum(sM), sx = hsum(sX), sy = hsum(sY), sxx = hsum(sXX), sxy = hsum(sXY);
+  double det = s * sxx - sx * sx;
+  double slope = 0, intercept = sy / s;
+  if (theNHits > 1 && det > 0) {
+    slope = (s * sxy - sx * sy) / det;
+    intercept = (sxx * sy - sx * sxy) / det;
+  }
+
+  result.nDof = theNHits;
+  result.invBeta = invBeta;
+  result.freeInvBeta = slope;
+  result.timeAtIpInOut = timeIO;
+  result.timeAtIpOutIn = timeOI;
+  if (theNHits < 2) return result;
+
+  // second pass: residuals
+  v4sf rIb = {0, 0, 0, 0}, rIO = rIb, rOI = rIb, rLine = rIb;
+  const float fInvBeta = invBeta, fTimeIO = timeIO, fTimeOI = timeOI, fSlope = slope, fIntercept = intercept;
+  for (unsigned int i = 0; i < n; i += theWidth) {
+    v4sf d = load(dist + i), t = load(t0 + i), w = load(weight + i), m = load(mask + i);
+    v4sf x = d / c;
+    v4sf dib = 1.f + t / x - fInvBeta;
+    v4sf dio = t - fTimeIO;
+    v4sf doi = t + 2.f * x - fTimeOI;
+    v4sf dline = t + x - fIntercept - fSlope * x;
+    rIb += x * x * w * dib * dib;
+    rIO += w * dio * dio;
+    rOI += w * doi * doi;
+    rLine += m * dline * dline;
+  }
+
+  double cf = 1. / (theNHits - 1);
+  result.invBetaErr = sqrt(hsum(rIb) / totalWib * cf);
+  result.timeAtIpInOutErr = sqrt(hsum(rIO) / totalWt * cf);
+  result.timeAtIpOutInErr = sqrt(hsum(rOI) / totalWt * cf);
+  if (theNHits > 2 && det > 0)
+    result.freeInvBetaErr = sqrt(hsum(rLine) / (theNHits - 2) * s / det);
+
+  return result;
+}
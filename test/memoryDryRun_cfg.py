@@ -0,0 +1,20 @@
+# Memory prediction from the cfi alone: books the histograms and trees of the modules without
+# reading any event and prints their footprint (the "max" column is the peak once every bin of
+# the sparse histograms is filled). Change the parameters below as in the real job, e.g. nbins.
+#   cmsRun memoryDryRun_cfg.py
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("MEMORY")
+
+process.source = cms.Source("EmptySource")
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(0))
+
+process.load("UserCode.HSCPTOF.MuonTimingAnalyzer_cfi")
+process.load("UserCode.HSCPTOF.AodTimingAnalyzer_cfi")
+process.load("UserCode.HSCPTOF.MuonNtupleFiller_cfi")
+
+for module in (process.muonTimingAnalyzer, process.aodTimingAnalyzer, process.muonNtupleFiller):
+    module.memoryReport = True
+    module.out = "memoryDryRun_" + module.out.value()
+
+process.p = cms.Path(process.muonTimingAnalyzer + process.aodTimingAnalyzer + process.muonNtupleFiller)
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Thread-scaling benchmark of the HSCPTOF modules at 1/2/4/8/16 threads over one local input file,
+# the table goes to scaling.txt (compare it between releases with diff).
+#   threadScaling.sh /data/hscptof_bench.root [maxEvents]
+input=$1
+events=${2:-2000}
+if [ -z "$input" ]; then
+  echo "Usage: $0 input.root [maxEvents]"
+  exit 1
+fi
+dir=$(dirname $0)
+
+for module in muonTimingAnalyzer aodTimingAnalyzer muonNtupleFiller; do
+  for threads in 1 2 4 8 16; do
+    echo "$module, $threads thread(s)"
+    cmsRun -j fjr_${module}_${threads}.xml $dir/threadScaling_cfg.py module=$module threads=$threads \
+           inputFiles=file:$input maxEvents=$events > log_${module}_${threads}.txt 2>&1 \
+      || echo "  failed, see log_${module}_${threads}.txt"
+  done
+done
+
+hscptofScaling fjr_*.xml | tee scaling.txt
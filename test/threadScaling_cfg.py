@@ -0,0 +1,49 @@
+# Thread-scaling benchmark job: one HSCPTOF module over a fixed local input.
+#   cmsRun -j fjr_muonTimingAnalyzer_4.xml threadScaling_cfg.py module=muonTimingAnalyzer threads=4 \
+#          inputFiles=file:/data/hscptof_bench.root
+# The Timing and SimpleMemoryCheck services write the throughput, CPU time and peak RSS into the
+# job report, collected by hscptofScaling (see threadScaling.sh). The modules are legacy
+# EDAnalyzers, so the framework runs them one event at a time: the table shows how much the
+# rest of the job (input, unpacking of the products) gains from the threads.
+import FWCore.ParameterSet.Config as cms
+from FWCore.ParameterSet.VarParsing import VarParsing
+
+options = VarParsing("analysis")
+options.register("module", "muonTimingAnalyzer", VarParsing.multiplicity.singleton, VarParsing.varType.string,
+                 "muonTimingAnalyzer, aodTimingAnalyzer or muonNtupleFiller")
+options.register("threads", 1, VarParsing.multiplicity.singleton, VarParsing.varType.int,
+                 "number of threads (and streams)")
+options.register("globalTag", "auto:phase1_2018_realistic", VarParsing.multiplicity.singleton,
+                 VarParsing.varType.string, "global tag")
+options.maxEvents = 2000
+options.parseArguments()
+
+process = cms.Process("SCALING")
+
+process.load("FWCore.MessageService.MessageLogger_cfi")
+process.MessageLogger.cerr.FwkReport.reportEvery = 1000
+process.load("Configuration.StandardSequences.GeometryRecoDB_cff")
+process.load("Configuration.StandardSequences.MagneticField_cff")
+process.load("Configuration.StandardSequences.FrontierConditions_GlobalTag_cff")
+from Configuration.AlCa.GlobalTag import GlobalTag
+process.GlobalTag = GlobalTag(process.GlobalTag, options.globalTag, "")
+
+process.source = cms.Source("PoolSource", fileNames = cms.untracked.vstring(options.inputFiles))
+process.maxEvents = cms.untracked.PSet(input = cms.untracked.int32(options.maxEvents))
+process.options = cms.untracked.PSet(
+    numberOfThreads = cms.untracked.uint32(options.threads),
+    numberOfStreams = cms.untracked.uint32(options.threads),
+    wantSummary = cms.untracked.bool(False)
+)
+
+process.Timing = cms.Service("Timing", summaryOnly = cms.untracked.bool(True))
+process.SimpleMemoryCheck = cms.Service("SimpleMemoryCheck", jobReportOutputOnly = cms.untracked.bool(True))
+
+cfis = {"muonTimingAnalyzer": "MuonTimingAnalyzer_cfi",
+        "aodTimingAnalyzer": "AodTimingAnalyzer_cfi",
+        "muonNtupleFiller": "MuonNtupleFiller_cfi"}
+process.load("UserCode.HSCPTOF." + cfis[options.module])
+module = getattr(process, options.module)
+module.out = "scaling_%s_%d.root" % (options.module, options.threads)
+
+process.p = cms.Path(module)